@@ -0,0 +1,61 @@
+#include <cstdlib>
+#include <new>
+#include "AllocationCounter.h"
+#include "log.h"
+
+#ifdef COUNT_FRAME_ALLOCATIONS
+static thread_local uint64_t threadAllocations = 0;
+
+static void *countedAlloc(size_t size) {
+    threadAllocations++;
+    void *p = malloc(size ? size : 1);
+    if (p == nullptr) throw std::bad_alloc();
+    return p;
+}
+
+void *operator new(size_t size) { return countedAlloc(size); }
+
+void *operator new[](size_t size) { return countedAlloc(size); }
+
+void operator delete(void *p) noexcept { free(p); }
+
+void operator delete[](void *p) noexcept { free(p); }
+
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+void operator delete[](void *p, size_t) noexcept { free(p); }
+#endif // COUNT_FRAME_ALLOCATIONS
+
+namespace ssnwt {
+    // Covers the first latch, swapchain images coming round for the first time and so on.
+    constexpr uint32_t WARM_UP_FRAMES = 120;
+
+    uint64_t AllocationCounter::getThreadCount() {
+#ifdef COUNT_FRAME_ALLOCATIONS
+        return threadAllocations;
+#else
+        return 0;
+#endif
+    }
+
+    void AllocationCounter::frameStart() {
+        mStartCount = getThreadCount();
+    }
+
+    void AllocationCounter::frameEnd() {
+        const uint64_t allocations = getThreadCount() - mStartCount;
+        if (mFrames < WARM_UP_FRAMES) {
+            mFrames++;
+            return;
+        }
+        if (allocations != 0) {
+            ALOGE("[AllocationCounter]%llu heap allocations in a steady state frame",
+                  (unsigned long long) allocations);
+            abort();
+        }
+    }
+
+    void AllocationCounter::reset() {
+        mFrames = 0;
+    }
+}
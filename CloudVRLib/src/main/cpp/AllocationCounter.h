@@ -0,0 +1,38 @@
+#ifndef CLOUDXR_ALLOCATIONCOUNTER_H
+#define CLOUDXR_ALLOCATIONCOUNTER_H
+
+#include <cstdint>
+
+namespace ssnwt {
+    /**
+     * Checks that the frame loop stops touching the heap once it has warmed up, an allocation
+     * at 90 Hz is a likely long frame. operator new is only counted when built with
+     * COUNT_FRAME_ALLOCATIONS, elsewhere every check passes for free.
+     *
+     * Only the plain, array and sized forms of operator new/delete are replaced, nothrow new
+     * is counted because libc++ forwards it to the plain one. Not counted: aligned
+     * (std::align_val_t) new, malloc/calloc/realloc called directly and whatever the GL
+     * driver, the OpenXR runtime or the CloudXR SDK allocate inside.
+     */
+    class AllocationCounter {
+    public:
+        // operator new calls the calling thread made so far, always 0 without
+        // COUNT_FRAME_ALLOCATIONS.
+        static uint64_t getThreadCount();
+
+        void frameStart();
+
+        // Aborts on any allocation during the frame after the warm up, so it can't be missed
+        // in the log. Not an assert, NDEBUG would compile it out.
+        void frameEnd();
+
+        // The loop reconfigured itself, give it a new warm up.
+        void reset();
+
+    private:
+        uint64_t mStartCount = 0;
+        uint32_t mFrames = 0;
+    };
+}
+
+#endif //CLOUDXR_ALLOCATIONCOUNTER_H
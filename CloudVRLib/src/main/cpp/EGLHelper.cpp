@@ -6,6 +6,15 @@
 #include "log.h"
 
 namespace ssnwt {
+    static const EGLint CONTEXT_ATTRIBS[] = {
+            EGL_CONTEXT_CLIENT_VERSION, 3,
+#ifdef GL_DEBUG
+            // Lets GL_KHR_debug report everything the driver catches.
+            EGL_CONTEXT_FLAGS_KHR, EGL_CONTEXT_OPENGL_DEBUG_BIT_KHR,
+#endif
+            EGL_NONE
+    };
+
     bool EGLHelper::initialize() {
         if (mContext)
             return true; // already initialized
@@ -53,11 +62,7 @@ namespace ssnwt {
             ALOGE("[EGLHelper]failed to find EGL config");
             return false;
         }
-        EGLint contextAttribs[] = {
-                EGL_CONTEXT_CLIENT_VERSION, 3,
-                EGL_NONE
-        };
-        mContext = eglCreateContext(mDisplay, mConfig, nullptr, contextAttribs);
+        mContext = eglCreateContext(mDisplay, mConfig, nullptr, CONTEXT_ATTRIBS);
         if (mContext == EGL_NO_CONTEXT) {
             ALOGE("[EGLHelper]eglCreateContext failed");
             return false;
@@ -66,6 +71,22 @@ namespace ssnwt {
         return true;
     }
 
+    bool EGLHelper::initializeShared(const EGLHelper &shared) {
+        if (mContext)
+            return true; // already initialized
+
+        mDisplay = shared.mDisplay;
+        mConfig = shared.mConfig;
+        mShared = true;
+        mContext = eglCreateContext(mDisplay, mConfig, shared.mContext, CONTEXT_ATTRIBS);
+        if (mContext == EGL_NO_CONTEXT) {
+            ALOGE("[EGLHelper]eglCreateContext shared failed");
+            return false;
+        }
+        ALOGD("[EGLHelper]mContext:%p shared with %p", mContext, shared.mContext);
+        return true;
+    }
+
     bool EGLHelper::setSurface() {
         if (mSurface) {
             eglDestroySurface(mDisplay, mSurface);
@@ -121,9 +142,9 @@ namespace ssnwt {
             mSurface = nullptr;
         }
 
-        if (mDisplay) {
+        if (mDisplay && !mShared) {
             eglTerminate(mDisplay);
-            mDisplay = nullptr;
         }
+        mDisplay = nullptr;
     }
 }
\ No newline at end of file
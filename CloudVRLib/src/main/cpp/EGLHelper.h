@@ -9,6 +9,10 @@ namespace ssnwt {
     public:
         bool initialize();
 
+        // A context for another thread, sharing objects with shared. Make it current on that
+        // thread with setSurface().
+        bool initializeShared(const EGLHelper &shared);
+
         bool setSurface(ANativeWindow *window);
 
         bool setSurface();
@@ -29,6 +33,7 @@ namespace ssnwt {
         EGLContext mContext = 0;
         EGLSurface mSurface = 0;
         EGLint mWidth = 0, mHeight = 0;
+        bool mShared = false;   // the display belongs to another EGLHelper
     };
 }
 #endif //CLIENT_APP_OVR_EGLHELPER_H
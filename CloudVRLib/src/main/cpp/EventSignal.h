@@ -0,0 +1,50 @@
+#ifndef CLOUDXR_EVENTSIGNAL_H
+#define CLOUDXR_EVENTSIGNAL_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+namespace ssnwt {
+    /**
+     * Wakes a thread blocked waiting for something to happen on other threads.
+     * Events are bits posted by anyone and collected by one waiter, a post before the wait is
+     * kept until then, so the waiter can check its state first and block afterwards.
+     */
+    class EventSignal {
+    public:
+        void post(uint32_t events) {
+            {
+                std::lock_guard<std::mutex> lockGuard(mMutex);
+                mPending |= events;
+            }
+            mCondition.notify_one();
+        }
+
+        // Blocks until something is posted, returns and clears everything pending.
+        uint32_t wait() {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mCondition.wait(lock, [this] { return mPending != 0; });
+            const uint32_t events = mPending;
+            mPending = 0;
+            return events;
+        }
+
+        // Same, but gives up at deadline and returns 0 then.
+        uint32_t waitUntil(std::chrono::steady_clock::time_point deadline) {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mCondition.wait_until(lock, deadline, [this] { return mPending != 0; });
+            const uint32_t events = mPending;
+            mPending = 0;
+            return events;
+        }
+
+    private:
+        std::mutex mMutex;
+        std::condition_variable mCondition;
+        uint32_t mPending = 0;
+    };
+}
+
+#endif //CLOUDXR_EVENTSIGNAL_H
@@ -0,0 +1,37 @@
+#ifndef CLOUDXR_GPUMEMORY_H
+#define CLOUDXR_GPUMEMORY_H
+
+#include <atomic>
+#include <cstdint>
+#include "log.h"
+
+namespace ssnwt {
+    /**
+     * Running total of the render targets and textures we size ourselves, logged on every
+     * change. An estimate from the dimensions, drivers pad and compress as they see fit.
+     */
+    class GpuMemory {
+    public:
+        static constexpr int64_t RGBA8_BYTES = 4;
+
+        static void allocated(const char *what, int64_t bytes) {
+            const int64_t total = getTotal().fetch_add(bytes) + bytes;
+            ALOGD("[GpuMemory]+%.1f MB %s, %.1f MB in total", toMB(bytes), what, toMB(total));
+        }
+
+        static void released(const char *what, int64_t bytes) {
+            const int64_t total = getTotal().fetch_sub(bytes) - bytes;
+            ALOGD("[GpuMemory]-%.1f MB %s, %.1f MB in total", toMB(bytes), what, toMB(total));
+        }
+
+    private:
+        static std::atomic<int64_t> &getTotal() {
+            static std::atomic<int64_t> total{0};
+            return total;
+        }
+
+        static double toMB(int64_t bytes) { return (double) bytes / (1024.0 * 1024.0); }
+    };
+}
+
+#endif //CLOUDXR_GPUMEMORY_H
@@ -1,7 +1,14 @@
+#include <cstring>
+#include <EGL/egl.h>
 #include "GraphicRender.h"
+#include "GpuMemory.h"
 #include "log.h"
 
 namespace ssnwt {
+    // Bound before linking, so every program shares the same vertex arrays.
+    constexpr GLuint POSITION_ATTRIB = 0;
+    constexpr GLuint TEXTURE_COORD_ATTRIB = 1;
+
     void GraphicRender::clear() {
         glClearColor(0, 0, 0, 1);
         glClear(GL_COLOR_BUFFER_BIT);
@@ -19,55 +26,133 @@ namespace ssnwt {
         }
         mWidth = width;
         mHeight = height;
-        createProgram(VERTEX_SHADER, FRAGMENT_SHADER);
+        enableDebugOutput();
+        createProgram(VERTEX_SHADER, FRAGMENT_SHADER, &mProgram);
+        glUseProgram(mProgram.id);
+        glUniformMatrix4fv(mProgram.uMVPMatrixHandle, 1, false, mMVPMatrix);
+        glUseProgram(0);
+        createVertexArrays();
         mTextureID[0] = createTexture();
         mTextureID[1] = createTexture();
-        mFrameBuffer[0] = createFrameBuffer(width / 2, height);
-        mFrameBuffer[1] = createFrameBuffer(width / 2, height);
+        mFrameBuffer[0] = createFrameBuffer(mTextureID[0]);
+        mFrameBuffer[1] = createFrameBuffer(mTextureID[1]);
+        GpuMemory::allocated("eye textures", 2 * (int64_t) (width / 2) * height *
+                                             GpuMemory::RGBA8_BYTES);
         checkGlError("initialize");
     }
 
     void GraphicRender::release() {
         if (mTextureID[0] > 0 && mTextureID[1] > 0) {
             glDeleteTextures(2, mTextureID);
+            GpuMemory::released("eye textures", 2 * (int64_t) (mWidth / 2) * mHeight *
+                                                GpuMemory::RGBA8_BYTES);
         }
         if (mFrameBuffer[0] > 0 && mFrameBuffer[1] > 0) {
             glDeleteFramebuffers(2, mFrameBuffer);
         }
-        if (mProgram > 0) {
-            glDeleteProgram(mProgram);
+        if (mProgram.id > 0) {
+            glDeleteProgram(mProgram.id);
+        }
+        if (mMultiviewProgram.id > 0) {
+            glDeleteProgram(mMultiviewProgram.id);
+        }
+        if (mVertexBuffer > 0) {
+            glDeleteVertexArrays(2, mVertexArray);
+            glDeleteBuffers(1, &mVertexBuffer);
         }
     }
 
     void GraphicRender::draw(const uint32_t eye) {
-        glUseProgram(mProgram);
-        checkGlError("glUseProgram");
-        glBindTexture(GL_TEXTURE_2D, mTextureID[eye]);
-        draw(PositionVertex[eye], TextureVertex);
+        glUseProgram(mProgram.id);
+        glBindTexture(GL_TEXTURE_2D, getTexture(eye));
+        setWarpUniform(&mProgram, mWarp[eye], 1);
+        glBindVertexArray(mVertexArray[eye]);
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        glBindVertexArray(0);
         glUseProgram(0);
     }
 
-    void GraphicRender::draw(const float *position, const float *uv) {
-        glVertexAttribPointer(maPositionHandle, 3, GL_FLOAT, false, 3 * 4, position);
-        checkGlError("glVertexAttribPointer maPosition");
-        glEnableVertexAttribArray(maPositionHandle);
-        checkGlError("glEnableVertexAttribArray maPositionHandle");
+#ifdef XR_USE_OPENXR
+    bool GraphicRender::initializeMultiview() {
+        if (mMultiviewProgram.id > 0) return true;
+        if (!createProgram(MULTIVIEW_VERTEX_SHADER, MULTIVIEW_FRAGMENT_SHADER,
+                           &mMultiviewProgram)) {
+            ALOGW("[GraphicRender]Multiview unavailable, drawing one eye at a time");
+            return false;
+        }
+        glUseProgram(mMultiviewProgram.id);
+        glUniform1i(glGetUniformLocation(mMultiviewProgram.id, "sTexture0"), 0);
+        glUniform1i(glGetUniformLocation(mMultiviewProgram.id, "sTexture1"), 1);
+        glUniformMatrix4fv(mMultiviewProgram.uMVPMatrixHandle, 1, false, mMVPMatrix);
+        glUseProgram(0);
+        createVertexArrays();
+        checkGlError("initializeMultiview");
+        return true;
+    }
 
-        glVertexAttribPointer(maTextureHandle, 2, GL_FLOAT, false, 2 * 4, uv);
-        checkGlError("glVertexAttribPointer maTextureHandle");
-        glEnableVertexAttribArray(maTextureHandle);
-        checkGlError("glEnableVertexAttribArray maTextureHandle");
+    void GraphicRender::drawMultiview() {
+        glUseProgram(mMultiviewProgram.id);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, getTexture(1));
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, getTexture(0));
+        setWarpUniform(&mMultiviewProgram, mWarp[0], 2);
+        // Both eyes share the full-viewport quad in OpenXR mode.
+        glBindVertexArray(mVertexArray[0]);
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        glBindVertexArray(0);
+        glUseProgram(0);
+    }
+#endif // XR_USE_OPENXR
 
-        glUniformMatrix4fv(muMVPMatrixHandle, 1, false, mMVPMatrix);
+    void GraphicRender::setSourceTextures(GLuint left, GLuint right) {
+        mSourceTextureID[0] = left;
+        mSourceTextureID[1] = right;
+    }
 
-        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-        checkGlError("glDrawArrays");
+    void GraphicRender::setWarp(uint32_t eye, const float warp[9]) {
+        static const float IDENTITY[9] = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+        memcpy(mWarp[eye], warp ? warp : IDENTITY, sizeof(mWarp[eye]));
+    }
+
+    void GraphicRender::createVertexArrays() {
+        if (mVertexBuffer > 0) return;
+        glGenBuffers(1, &mVertexBuffer);
+        glBindBuffer(GL_ARRAY_BUFFER, mVertexBuffer);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(PositionVertex) + sizeof(TextureVertex), nullptr,
+                     GL_STATIC_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(PositionVertex), PositionVertex);
+        glBufferSubData(GL_ARRAY_BUFFER, sizeof(PositionVertex), sizeof(TextureVertex),
+                        TextureVertex);
+
+        glGenVertexArrays(2, mVertexArray);
+        for (uint32_t eye = 0; eye < 2; eye++) {
+            glBindVertexArray(mVertexArray[eye]);
+            glVertexAttribPointer(POSITION_ATTRIB, 3, GL_FLOAT, false, 3 * 4,
+                                  reinterpret_cast<const void *>(sizeof(PositionVertex[0]) * eye));
+            glEnableVertexAttribArray(POSITION_ATTRIB);
+            glVertexAttribPointer(TEXTURE_COORD_ATTRIB, 2, GL_FLOAT, false, 2 * 4,
+                                  reinterpret_cast<const void *>(sizeof(PositionVertex)));
+            glEnableVertexAttribArray(TEXTURE_COORD_ATTRIB);
+        }
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        checkGlError("createVertexArrays");
+    }
+
+    void GraphicRender::setWarpUniform(Program *program, const float *warp, GLsizei count) {
+        const size_t size = sizeof(program->warp[0]) * count;
+        if (program->warpUploaded && memcmp(program->warp, warp, size) == 0) return;
+        glUniformMatrix3fv(program->uWarpHandle, count, false, warp);
+        memcpy(program->warp, warp, size);
+        program->warpUploaded = true;
     }
 
     bool GraphicRender::setupFrameBuffer(int32_t eye) {
         glBindFramebuffer(GL_DRAW_FRAMEBUFFER, mFrameBuffer[eye]);
-        glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER,
-                               GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, mTextureID[eye], 0);
+        // The blit covers all of it, a tiler needn't load the last frame first.
+        const GLenum attachment = GL_COLOR_ATTACHMENT0;
+        glInvalidateFramebuffer(GL_DRAW_FRAMEBUFFER, 1, &attachment);
         return true;
     }
 
@@ -75,24 +160,20 @@ namespace ssnwt {
         glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
     }
 
-    GLuint GraphicRender::createFrameBuffer(int32_t width, int32_t height) {
-        GLuint framebuffer, rbo;
+    GLuint GraphicRender::createFrameBuffer(GLuint texture) {
+        GLuint framebuffer;
         glGenFramebuffers(1, &framebuffer);
-        glGenRenderbuffers(1, &rbo);
-
-        glBindRenderbuffer(GL_RENDERBUFFER, rbo);
-        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
-        glBindRenderbuffer(GL_RENDERBUFFER, 0);
 
         glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffer);
-        glFramebufferRenderbuffer(GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
-                                  GL_RENDERBUFFER, rbo);
+        glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                               texture, 0);
 
         GLenum status = glCheckFramebufferStatus(GL_DRAW_FRAMEBUFFER);
         glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
 
         if (status != GL_FRAMEBUFFER_COMPLETE) {
             ALOGV("[GraphicRender]Incomplete frame buffer object!");
+            glDeleteFramebuffers(1, &framebuffer);
             return 0;
         }
         return framebuffer;
@@ -108,13 +189,14 @@ namespace ssnwt {
         glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, mWidth / 2, mHeight,
-                     0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+        // Immutable, the size never changes until release().
+        glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, mWidth / 2, mHeight);
         checkGlError("createTexture");
         return texture;
     }
 
-    void GraphicRender::createProgram(const char *vertexSource, const char *fragmentSource) {
+    bool GraphicRender::createProgram(const char *vertexSource, const char *fragmentSource,
+                                      Program *program) {
         GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
         glShaderSource(vertexShader, 1, &vertexSource, nullptr);
         glCompileShader(vertexShader);
@@ -125,21 +207,27 @@ namespace ssnwt {
         glCompileShader(fragmentShader);
         checkShader(fragmentShader);
 
-        mProgram = glCreateProgram();
-        glAttachShader(mProgram, vertexShader);
-        glAttachShader(mProgram, fragmentShader);
-        glLinkProgram(mProgram);
-        checkProgram(mProgram);
+        GLuint prog = glCreateProgram();
+        glAttachShader(prog, vertexShader);
+        glAttachShader(prog, fragmentShader);
+        glBindAttribLocation(prog, POSITION_ATTRIB, "aPosition");
+        glBindAttribLocation(prog, TEXTURE_COORD_ATTRIB, "aTextureCoord");
+        glLinkProgram(prog);
+        const bool linked = checkProgram(prog);
 
         glDeleteShader(vertexShader);
         glDeleteShader(fragmentShader);
+        if (!linked) {
+            glDeleteProgram(prog);
+            return false;
+        }
 
-        muMVPMatrixHandle = glGetUniformLocation(mProgram, "uMVPMatrix");
-        checkGlError("glGetUniformLocation uMVPMatrix");
-        maPositionHandle = glGetAttribLocation(mProgram, "aPosition");
-        checkGlError("glGetAttribLocation aPosition");
-        maTextureHandle = glGetAttribLocation(mProgram, "aTextureCoord");
-        checkGlError("glGetAttribLocation aTextureCoord");
+        program->id = prog;
+        program->uMVPMatrixHandle = glGetUniformLocation(prog, "uMVPMatrix");
+        program->uWarpHandle = glGetUniformLocation(prog, "uWarp");
+        program->warpUploaded = false;
+        checkGlError("createProgram");
+        return true;
     }
 
     void GraphicRender::checkShader(GLuint shader) {
@@ -153,7 +241,7 @@ namespace ssnwt {
         }
     }
 
-    void GraphicRender::checkProgram(GLuint prog) {
+    bool GraphicRender::checkProgram(GLuint prog) {
         GLint r = 0;
         glGetProgramiv(prog, GL_LINK_STATUS, &r);
         if (r == GL_FALSE) {
@@ -162,12 +250,41 @@ namespace ssnwt {
             glGetProgramInfoLog(prog, sizeof(msg), &length, msg);
             ALOGE("[GraphicRender]Link program failed: %s", msg);
         }
+        return r != GL_FALSE;
     }
 
     void GraphicRender::checkGlError(const char *op) {
+#ifdef GL_DEBUG
         uint32_t error;
         while ((error = glGetError()) != GL_NO_ERROR) {
             ALOGE("[GraphicRender]%s : glError %d", op, error);
         }
+#else
+        (void) op;
+#endif
+    }
+
+    void GraphicRender::enableDebugOutput() {
+#ifdef GL_DEBUG
+        const char *extensions = reinterpret_cast<const char *>(glGetString(GL_EXTENSIONS));
+        auto debugMessageCallback = reinterpret_cast<PFNGLDEBUGMESSAGECALLBACKKHRPROC>(
+                eglGetProcAddress("glDebugMessageCallbackKHR"));
+        if (extensions == nullptr || strstr(extensions, "GL_KHR_debug") == nullptr ||
+            debugMessageCallback == nullptr) {
+            ALOGW("[GraphicRender]GL_KHR_debug unsupported, GL errors go unreported");
+            return;
+        }
+        debugMessageCallback([](GLenum source, GLenum type, GLuint id, GLenum severity,
+                                GLsizei length, const GLchar *message, const void *userParam) {
+            if (type == GL_DEBUG_TYPE_ERROR_KHR) {
+                ALOGE("[GraphicRender]GL error %u: %s", id, message);
+            } else if (severity != GL_DEBUG_SEVERITY_NOTIFICATION_KHR) {
+                ALOGW("[GraphicRender]GL %u: %s", id, message);
+            }
+        }, nullptr);
+        glEnable(GL_DEBUG_OUTPUT_KHR);
+        // Reports land on the thread and call that caused them.
+        glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS_KHR);
+#endif
     }
 }
\ No newline at end of file
@@ -2,29 +2,75 @@
 #define CLOUDXR_GRAPHICRENDER_H
 
 #include <GLES3/gl32.h>
+#include <GLES2/gl2ext.h>
 #include <unordered_map>
 
 namespace ssnwt {
+    // uWarp reprojects the texture coordinate, it stays homogeneous until the fragment
+    // shader so the warp is perspective correct across the quad.
     static const char *VERTEX_SHADER = R"_(
         uniform mat4 uMVPMatrix;
+        uniform mat3 uWarp;
         attribute vec4 aPosition;
         attribute vec4 aTextureCoord;
-        varying vec2 vTextureCoord;
+        varying vec3 vTextureCoord;
         void main() {
             gl_Position = uMVPMatrix * aPosition;
-            vTextureCoord = aTextureCoord.xy;
+            vTextureCoord = uWarp * vec3(aTextureCoord.xy, 1.0);
         }
     )_";
 
     static const char *FRAGMENT_SHADER = R"_(
-        precision mediump float;
-        varying vec2 vTextureCoord;
+        precision highp float;
+        varying vec3 vTextureCoord;
         uniform sampler2D sTexture;
         void main() {
-            gl_FragColor = texture2D(sTexture, vTextureCoord);
+            vec2 uv = vTextureCoord.xy / vTextureCoord.z;
+            if (vTextureCoord.z <= 0.0 || any(lessThan(uv, vec2(0.0))) ||
+                any(greaterThan(uv, vec2(1.0)))) {
+                gl_FragColor = vec4(0.0, 0.0, 0.0, 1.0);
+            } else {
+                gl_FragColor = texture2D(sTexture, uv);
+            }
         }
     )_";
 #ifdef XR_USE_OPENXR
+    // Both eyes in one GL_OVR_multiview2 pass into a 2-layer framebuffer, each view samples
+    // its own eye texture with its own warp.
+    static const char *MULTIVIEW_VERTEX_SHADER = R"_(#version 300 es
+        #extension GL_OVR_multiview2 : require
+        layout(num_views = 2) in;
+        uniform mat4 uMVPMatrix;
+        uniform mat3 uWarp[2];
+        in vec4 aPosition;
+        in vec4 aTextureCoord;
+        out vec3 vTextureCoord;
+        void main() {
+            gl_Position = uMVPMatrix * aPosition;
+            vTextureCoord = uWarp[int(gl_ViewID_OVR)] * vec3(aTextureCoord.xy, 1.0);
+        }
+    )_";
+
+    static const char *MULTIVIEW_FRAGMENT_SHADER = R"_(#version 300 es
+        #extension GL_OVR_multiview2 : require
+        precision highp float;
+        in vec3 vTextureCoord;
+        uniform sampler2D sTexture0;
+        uniform sampler2D sTexture1;
+        out vec4 outColor;
+        void main() {
+            vec2 uv = vTextureCoord.xy / vTextureCoord.z;
+            if (vTextureCoord.z <= 0.0 || any(lessThan(uv, vec2(0.0))) ||
+                any(greaterThan(uv, vec2(1.0)))) {
+                outColor = vec4(0.0, 0.0, 0.0, 1.0);
+            } else if (gl_ViewID_OVR == 0u) {
+                outColor = texture(sTexture0, uv);
+            } else {
+                outColor = texture(sTexture1, uv);
+            }
+        }
+    )_";
+
     constexpr float PositionVertex[2][12] = {
             {
                     // X, Y, Z
@@ -73,10 +119,28 @@ namespace ssnwt {
 
         static void clear(uint32_t eye);
 
+        // The eye textures are GL_RGBA8 like the color swapchain, the stream is already
+        // gamma encoded and goes through unconverted.
         void initialize(int32_t width, int32_t height);
 
         void draw(const uint32_t eye);
 
+#ifdef XR_USE_OPENXR
+        // Compiles the multiview program, false when the driver lacks GL_OVR_multiview2.
+        bool initializeMultiview();
+
+        // Both eyes at once into the bound multiview framebuffer.
+        void drawMultiview();
+#endif // XR_USE_OPENXR
+
+        // Draws these instead of the textures initialize() made, 0 goes back to those.
+        void setSourceTextures(GLuint left, GLuint right);
+
+        // Reprojection of the eye's texture, nullptr draws it unwarped.
+        void setWarp(uint32_t eye, const float warp[9]);
+
+        // Binds the eye's framebuffer, its previous contents discarded. Only for a draw that
+        // covers all of it.
         bool setupFrameBuffer(int32_t eye);
 
         static void bindDefaultFrameBuffer();
@@ -84,31 +148,57 @@ namespace ssnwt {
         void release();
 
     private:
+        struct Program {
+            GLuint id = 0;
+            GLint uMVPMatrixHandle;
+            GLint uWarpHandle;
+            // Last upload to uWarp, valid once warpUploaded.
+            float warp[2][9];
+            bool warpUploaded = false;
+        };
+
         GLuint createTexture() const;
 
-        static GLuint createFrameBuffer(int32_t width, int32_t height);
+        GLuint getTexture(uint32_t eye) const {
+            return mSourceTextureID[eye] ? mSourceTextureID[eye] : mTextureID[eye];
+        }
+
+        // Color only, the stream is drawn as flat quads that never need depth.
+        static GLuint createFrameBuffer(GLuint texture);
 
-        void draw(const float position[], const float uv[]);
+        // One static buffer holds both eyes' quads and the shared texture coordinates.
+        void createVertexArrays();
 
-        void createProgram(const char *vertexSource, const char *fragmentSource);
+        // Skips the upload when the program already has these count matrices.
+        static void setWarpUniform(Program *program, const float *warp, GLsizei count);
+
+        static bool createProgram(const char *vertexSource, const char *fragmentSource,
+                                  Program *program);
 
         static void checkShader(GLuint shader);
 
-        static void checkProgram(GLuint prog);
+        static bool checkProgram(GLuint prog);
 
+        // Compiled out unless GL_DEBUG, which reports errors through KHR_debug instead of
+        // polling glGetError in the frame loop.
         static void checkGlError(const char *op);
 
+        static void enableDebugOutput();
+
     private:
         float mMVPMatrix[16] = {1, 0, 0, 0,
                                 0, 1, 0, 0,
                                 0, 0, 1, 0,
                                 0, 0, 0, 1,};
-        GLuint mProgram;
+        float mWarp[2][9] = {{1, 0, 0, 0, 1, 0, 0, 0, 1},
+                             {1, 0, 0, 0, 1, 0, 0, 0, 1}};
+        Program mProgram;
+        Program mMultiviewProgram;
         GLuint mTextureID[2] = {0, 0};
+        GLuint mSourceTextureID[2] = {0, 0};
         GLuint mFrameBuffer[2] = {0, 0};
-        GLint muMVPMatrixHandle;
-        GLint maPositionHandle;
-        GLint maTextureHandle;
+        GLuint mVertexBuffer = 0;
+        GLuint mVertexArray[2] = {0, 0};
         GLint mWidth, mHeight;
     };
 }
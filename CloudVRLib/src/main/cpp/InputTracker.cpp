@@ -0,0 +1,59 @@
+#include <cstring>
+#include "InputTracker.h"
+
+namespace ssnwt {
+    uint32_t ButtonTracker::update(uint32_t rawButtons) {
+        uint32_t flipped = rawButtons ^ mButtons;
+        if (mDebounce > 0) {
+            uint32_t confirmed = 0;
+            for (uint32_t bit = 0; bit < mHoldCount.size(); bit++) {
+                if ((flipped & (1u << bit)) == 0) {
+                    mHoldCount[bit] = 0;
+                } else if (++mHoldCount[bit] >= mDebounce) {
+                    mHoldCount[bit] = 0;
+                    confirmed |= 1u << bit;
+                }
+            }
+            flipped = confirmed;
+        }
+        mPressed = flipped & ~mButtons;
+        mReleased = flipped & mButtons;
+        mButtons ^= flipped;
+        return mButtons;
+    }
+
+    void ButtonTracker::reset() {
+        mButtons = mPressed = mReleased = 0;
+        mHoldCount.fill(0);
+    }
+
+    bool ControllerSampleState::hasChanged(const cxrControllerTrackingState &controller) const {
+        return !mValid || controller.booleanComps != mBooleanComps ||
+               memcmp(mScalarComps, controller.scalarComps, sizeof(mScalarComps)) != 0;
+    }
+
+    void ControllerSampleState::update(const cxrControllerTrackingState &controller) {
+        mValid = true;
+        mBooleanComps = controller.booleanComps;
+        memcpy(mScalarComps, controller.scalarComps, sizeof(mScalarComps));
+    }
+
+    bool PacketEdges::claim(uint32_t version, cxrVRTrackingState *state) {
+        uint64_t buttons = 0;
+        for (uint32_t i = 0; i < CXR_NUM_CONTROLLERS; i++) {
+            buttons |= (uint64_t) (state->controller[i].booleanComps & 0xffff) << (16 * i);
+        }
+        const uint64_t claimed = (uint64_t) version << 32 | buttons;
+        uint64_t lastSent = mLastSent.load(std::memory_order_relaxed);
+        do {
+            if (version < (uint32_t) (lastSent >> 32)) return false;
+        } while (!mLastSent.compare_exchange_weak(lastSent, claimed, std::memory_order_relaxed));
+        // The same version again has no edges, skipped ones are folded in.
+        for (uint32_t i = 0; i < CXR_NUM_CONTROLLERS; i++) {
+            const uint32_t previous = (uint32_t) (lastSent >> (16 * i)) & 0xffff;
+            state->controller[i].booleanCompsChanged =
+                    previous ^ (state->controller[i].booleanComps & 0xffff);
+        }
+        return true;
+    }
+}
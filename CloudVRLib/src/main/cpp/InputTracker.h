@@ -0,0 +1,80 @@
+#ifndef CLOUDXR_INPUTTRACKER_H
+#define CLOUDXR_INPUTTRACKER_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <CloudXRCommon.h>
+
+namespace ssnwt {
+    /**
+     * Button state machine of one tracked device on the sampling thread.
+     * Optionally debounces each button and keeps the press/release edges of the last sample.
+     */
+    class ButtonTracker {
+    public:
+        // A button has to read a new state this many samples in a row to flip, 0 disables.
+        void setDebounce(uint32_t samples) { mDebounce = samples; }
+
+        // Feed the raw button mask of a new sample, returns the debounced mask.
+        uint32_t update(uint32_t rawButtons);
+
+        uint32_t getButtons() const { return mButtons; }
+
+        uint32_t getPressed() const { return mPressed; }
+
+        uint32_t getReleased() const { return mReleased; }
+
+        void reset();
+
+    private:
+        uint32_t mDebounce = 0;
+        uint32_t mButtons = 0;
+        uint32_t mPressed = 0;
+        uint32_t mReleased = 0;
+        std::array<uint8_t, 32> mHoldCount{};
+    };
+
+    /**
+     * Input of one controller in the previous sample, on the sampling thread. Tells whether a
+     * new sample has anything new to push.
+     */
+    class ControllerSampleState {
+    public:
+        // Buttons or analogs differ from the previous sample.
+        bool hasChanged(const cxrControllerTrackingState &controller) const;
+
+        void update(const cxrControllerTrackingState &controller);
+
+        void reset() { mValid = false; }
+
+    private:
+        bool mValid = false;
+        uint32_t mBooleanComps = 0;
+        float mScalarComps[cxrAnalog_Num] = {};
+    };
+
+    /**
+     * Buttons of the last packet sent, whichever thread sent it, and the version of the
+     * tracking snapshot it was. Both live in one atomic, so booleanCompsChanged always means
+     * "changed since the previous packet" and no packet goes out older than one already sent,
+     * without a lock on the pose poll thread.
+     */
+    class PacketEdges {
+    public:
+        // Claims the snapshot version for sending and fills the booleanCompsChanged of state.
+        // False when a newer snapshot went out already, the caller loads the newest again.
+        bool claim(uint32_t version, cxrVRTrackingState *state);
+
+        void reset() { mLastSent = 0; }
+
+    private:
+        static_assert(cxrButton_Num <= 16 && CXR_NUM_CONTROLLERS == 2,
+                      "the buttons of both controllers are packed in 32 bits");
+
+        // version << 32 | right buttons << 16 | left buttons
+        std::atomic<uint64_t> mLastSent{0};
+    };
+}
+
+#endif //CLOUDXR_INPUTTRACKER_H
@@ -0,0 +1,184 @@
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "PoseTrace.h"
+#include "PoseMath.h"
+
+namespace ssnwt {
+    // The file is grown and remapped this much at a time, about two minutes at 90 Hz.
+    constexpr size_t TRACE_CHUNK_SIZE = 4 * 1024 * 1024;
+    // 2 added PoseTraceRecord::measured.
+    constexpr uint32_t TRACE_VERSION = 2;
+
+    struct PoseTraceHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t recordSize;    // changes with the SDK's cxrVRTrackingState
+        uint32_t reserved;
+    };
+
+    static bool isValidHeader(const PoseTraceHeader &header) {
+        return memcmp(header.magic, "CXPT", 4) == 0 && header.version == TRACE_VERSION &&
+               header.recordSize == sizeof(PoseTraceRecord);
+    }
+
+    bool PoseTraceWriter::open(const char *path) {
+        close();
+        mFd = ::open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (mFd < 0) return false;
+        struct stat st{};
+        PoseTraceHeader header{{'C', 'X', 'P', 'T'}, TRACE_VERSION, sizeof(PoseTraceRecord), 0};
+        bool valid = fstat(mFd, &st) == 0;
+        const auto fileSize = (size_t) st.st_size;
+        if (valid && fileSize > 0) {
+            // Never touch a file that holds anything else.
+            valid = fileSize >= sizeof(header) &&
+                    pread(mFd, &header, sizeof(header), 0) == (ssize_t) sizeof(header) &&
+                    isValidHeader(header);
+        }
+        // Whole chunks, and always room for one more record. Growing only adds zeroed
+        // records, which read as unwritten.
+        if (!valid || !map((fileSize / TRACE_CHUNK_SIZE + 1) * TRACE_CHUNK_SIZE)) {
+            // Without trimming, close() would cut an existing trace to mSize.
+            if (mData != nullptr) munmap(mData, mCapacity);
+            mData = nullptr;
+            ::close(mFd);
+            mFd = -1;
+            mCapacity = 0;
+            return false;
+        }
+        if (fileSize == 0) {
+            memcpy(mData, &header, sizeof(header));
+            mSize = sizeof(header);
+            return true;
+        }
+        size_t count = (fileSize - sizeof(PoseTraceHeader)) / sizeof(PoseTraceRecord);
+        const auto *records = reinterpret_cast<const PoseTraceRecord *>(
+                mData + sizeof(PoseTraceHeader));
+        // A trace that was never closed ends in zeroed, unwritten records.
+        while (count > 0 && records[count - 1].timeNs == 0) count--;
+        mSize = sizeof(PoseTraceHeader) + count * sizeof(PoseTraceRecord);
+        return true;
+    }
+
+    bool PoseTraceWriter::map(size_t capacity) {
+        if (mData != nullptr) {
+            munmap(mData, mCapacity);
+            mData = nullptr;
+        }
+        if (ftruncate(mFd, (off_t) capacity) != 0) return false;
+        void *data = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, mFd, 0);
+        if (data == MAP_FAILED) return false;
+        mData = static_cast<uint8_t *>(data);
+        mCapacity = capacity;
+        return true;
+    }
+
+    bool PoseTraceWriter::append(int64_t timeNs, const cxrVRTrackingState &state,
+                                 const PoseSample &measured) {
+        if (mData == nullptr) return false;
+        if (mSize + sizeof(PoseTraceRecord) > mCapacity && !map(mCapacity + TRACE_CHUNK_SIZE)) {
+            return false;
+        }
+        PoseTraceRecord *record = reinterpret_cast<PoseTraceRecord *>(mData + mSize);
+        memcpy(&record->state, &state, sizeof(state));
+        memcpy(&record->measured, &measured, sizeof(measured));
+        // Time goes last, a record cut short by a crash still reads as unwritten.
+        record->timeNs = timeNs;
+        mSize += sizeof(PoseTraceRecord);
+        return true;
+    }
+
+    void PoseTraceWriter::close() {
+        if (mData != nullptr) {
+            munmap(mData, mCapacity);
+            mData = nullptr;
+        }
+        if (mFd >= 0) {
+            ftruncate(mFd, (off_t) mSize);
+            ::close(mFd);
+            mFd = -1;
+        }
+        mCapacity = 0;
+        mSize = 0;
+    }
+
+    size_t PoseTraceWriter::getCount() const {
+        return mSize > sizeof(PoseTraceHeader)
+               ? (mSize - sizeof(PoseTraceHeader)) / sizeof(PoseTraceRecord) : 0;
+    }
+
+    bool PoseTraceReader::open(const char *path) {
+        close();
+        mFd = ::open(path, O_RDONLY | O_CLOEXEC);
+        if (mFd < 0) return false;
+        struct stat st{};
+        if (fstat(mFd, &st) != 0 || (size_t) st.st_size < sizeof(PoseTraceHeader)) {
+            close();
+            return false;
+        }
+        mMappedSize = (size_t) st.st_size;
+        mData = mmap(nullptr, mMappedSize, PROT_READ, MAP_PRIVATE, mFd, 0);
+        if (mData == MAP_FAILED) {
+            mData = nullptr;
+            close();
+            return false;
+        }
+        if (!isValidHeader(*static_cast<const PoseTraceHeader *>(mData))) {
+            close();
+            return false;
+        }
+        mRecords = reinterpret_cast<const PoseTraceRecord *>(
+                static_cast<const uint8_t *>(mData) + sizeof(PoseTraceHeader));
+        mCount = (mMappedSize - sizeof(PoseTraceHeader)) / sizeof(PoseTraceRecord);
+        // A trace that was never closed ends in zeroed, unwritten records.
+        while (mCount > 0 && mRecords[mCount - 1].timeNs == 0) mCount--;
+        mNext = 0;
+        return true;
+    }
+
+    void PoseTraceReader::close() {
+        if (mData != nullptr) {
+            munmap(mData, mMappedSize);
+            mData = nullptr;
+        }
+        if (mFd >= 0) {
+            ::close(mFd);
+            mFd = -1;
+        }
+        mRecords = nullptr;
+        mMappedSize = 0;
+        mCount = 0;
+        mNext = 0;
+    }
+
+    bool PoseTraceReader::next(PoseTraceRecord *record) {
+        if (mNext >= mCount) {
+            if (!mLoop || mCount == 0) return false;
+            mNext = 0;
+        }
+        *record = mRecords[mNext++];
+        return true;
+    }
+
+    static void poseTraceToDevice(const cxrTrackedDevicePose &pose, DevicePose *device) {
+        const cxrMatrix34 &m = pose.deviceToAbsoluteTracking;
+        device->pose.orientation = quaternionFromMatrix(m);
+        device->pose.position = {m.m[0][3], m.m[1][3], m.m[2][3]};
+        device->linearVelocity = {pose.velocity.v[0], pose.velocity.v[1], pose.velocity.v[2]};
+        device->angularVelocity = {pose.angularVelocity.v[0], pose.angularVelocity.v[1],
+                                   pose.angularVelocity.v[2]};
+        device->valid = pose.poseIsValid == cxrTrue;
+    }
+
+    void trackingStateToSample(XrTime time, const cxrVRTrackingState &state, PoseSample *sample) {
+        sample->time = time;
+        poseTraceToDevice(state.hmd.pose, &sample->devices[Device::HMD]);
+        for (int side = 0; side < CXR_NUM_CONTROLLERS; side++) {
+            poseTraceToDevice(state.controller[side].pose,
+                              &sample->devices[Device::LEFT_HAND + side]);
+        }
+    }
+}
@@ -0,0 +1,84 @@
+//
+// Binary trace of the tracking states handed to the server, next to the poses they were
+// predicted from. Recorded through an append-only memory map and replayed in file order in
+// place of OpenXR. Free of Android dependencies so traces can be replayed on a Linux host.
+//
+
+#ifndef CLOUDXR_POSETRACE_H
+#define CLOUDXR_POSETRACE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <CloudXRCommon.h>
+#include "openxr/PoseHistory.h"
+
+namespace ssnwt {
+    struct PoseTraceRecord {
+        int64_t timeNs;             // steady clock, never 0 in a written record
+        cxrVRTrackingState state;   // as sent, extrapolated when a client-side model is on
+        PoseSample measured;        // as located, the ground truth to evaluate models against
+    };
+
+    class PoseTraceWriter {
+    public:
+        ~PoseTraceWriter() { close(); }
+
+        // Appends to the trace already at path, so reopening never loses a recording.
+        // Creates it when there is none, fails when path holds anything else.
+        bool open(const char *path);
+
+        bool isOpen() const { return mData != nullptr; }
+
+        // A memcpy into the mapping, the file only grows once per mapped chunk.
+        bool append(int64_t timeNs, const cxrVRTrackingState &state, const PoseSample &measured);
+
+        // Trims the file to the records written.
+        void close();
+
+        size_t getCount() const;
+
+    private:
+        bool map(size_t capacity);
+
+        int mFd = -1;
+        uint8_t *mData = nullptr;
+        size_t mCapacity = 0;
+        size_t mSize = 0;
+    };
+
+    class PoseTraceReader {
+    public:
+        ~PoseTraceReader() { close(); }
+
+        bool open(const char *path);
+
+        bool isOpen() const { return mRecords != nullptr; }
+
+        void close();
+
+        size_t getCount() const { return mCount; }
+
+        const PoseTraceRecord &at(size_t index) const { return mRecords[index]; }
+
+        // Next record in file order, starting over at the end when looping.
+        bool next(PoseTraceRecord *record);
+
+        void rewind() { mNext = 0; }
+
+        void setLoop(bool loop) { mLoop = loop; }
+
+    private:
+        int mFd = -1;
+        void *mData = nullptr;
+        size_t mMappedSize = 0;
+        const PoseTraceRecord *mRecords = nullptr;
+        size_t mCount = 0;
+        size_t mNext = 0;
+        bool mLoop = false;
+    };
+
+    // Decodes a tracking state back into pose form, for sources that only have the state.
+    void trackingStateToSample(XrTime time, const cxrVRTrackingState &state, PoseSample *sample);
+}
+
+#endif //CLOUDXR_POSETRACE_H
@@ -0,0 +1,47 @@
+#ifndef CLOUDXR_SEQLOCK_H
+#define CLOUDXR_SEQLOCK_H
+
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+
+namespace ssnwt {
+    /**
+     * Single-writer, multi-reader snapshot of a plain struct.
+     * The writer never blocks; readers copy the newest value and only retry when they
+     * overlapped a store, which is a memcpy long.
+     */
+    template<typename T>
+    class SeqLock {
+        static_assert(std::is_trivially_copyable<T>::value, "SeqLock needs a POD payload");
+
+    public:
+        // Must only be called from one thread. Returns the version load() will report for it.
+        uint32_t store(const T &value) {
+            const uint32_t seq = mSequence.load(std::memory_order_relaxed);
+            mSequence.store(seq + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            memcpy(&mValue, &value, sizeof(T));
+            mSequence.store(seq + 2, std::memory_order_release);
+            return (seq + 2) / 2;
+        }
+
+        // Copies the newest value and returns its version, 0 if nothing was stored yet.
+        uint32_t load(T *value) const {
+            uint32_t before, after;
+            do {
+                before = mSequence.load(std::memory_order_acquire);
+                memcpy(value, &mValue, sizeof(T));
+                std::atomic_thread_fence(std::memory_order_acquire);
+                after = mSequence.load(std::memory_order_relaxed);
+            } while ((before & 1) || before != after);
+            return before / 2;
+        }
+
+    private:
+        std::atomic<uint32_t> mSequence{0};
+        T mValue{};
+    };
+}
+
+#endif //CLOUDXR_SEQLOCK_H
@@ -1,22 +1,28 @@
 #include <android/native_window_jni.h>
+#include <atomic>
 #include <thread>
+#include <vector>
 #include <cstring>
 #include "log.h"
 #include "EGLHelper.h"
+#include "EventSignal.h"
 #include "GraphicRender.h"
 #include "FpsCounter.h"
+#include "AllocationCounter.h"
+#include "PoseMath.h"
 
 #ifdef XR_USE_CLOUDXR
 
 #include "nvidia/CloudXR.h"
-#include "matrix.h"
+#include "nvidia/FrameLatchThread.h"
+#include "PoseTrace.h"
+#include "openxr/PosePredictor.h"
 
 #endif // XR_USE_CLOUDXR
 
 #ifdef XR_USE_OPENXR
 
 #include "openxr/OpenXR.h"
-#include "matrix.h"
 
 #endif// XR_USE_OPENXR
 
@@ -36,56 +42,79 @@ ssnwt::OpenXR *pOpenXr = nullptr;
 ANativeWindow *pNativeWindow = nullptr;
 int32_t mSurfaceWidth = 0, mSurfaceHeight = 0;
 struct HMDInfo hmdInfo{};
-bool quit = false;
-bool paused = true;
-bool isSurfaceChanged = false;
-uint32_t lastBooleanComps = 0;
+std::atomic<bool> quit{false};
+std::atomic<bool> paused{true};
+std::atomic<bool> isSurfaceChanged{false};
+// Posted whenever anything the gl thread checks changes, instead of it polling.
+enum RenderEvent : uint32_t {
+    RenderEvent_SurfaceChanged = 1 << 0,
+    RenderEvent_Resume = 1 << 1,
+    RenderEvent_Pause = 1 << 2,
+    RenderEvent_ClientStateChanged = 1 << 3,
+    RenderEvent_Quit = 1 << 4,
+};
+ssnwt::EventSignal renderSignal{};
+// Only used on the gl thread.
+ssnwt::AllocationCounter frameAllocations{};
+#ifdef XR_USE_CLOUDXR
+// Only used on the gl thread, which also samples the tracking state.
+ssnwt::PoseTraceWriter poseRecorder{};
+ssnwt::PoseTraceReader poseReplay{};
+ssnwt::CloudXR *pCloudXr = nullptr;
+// Frame latched in the current loop iteration, nullptr when none is held.
+const cxrFramesLatched *pLatchedFrames = nullptr;
+// OpenXR mode blits streamed frames straight into the swapchain images from onDraw,
+// unless the shader reprojection or the latch thread needs them in textures first.
+bool directBlit = false;
+ssnwt::FrameLatchThread latchThread{};
+#endif // XR_USE_CLOUDXR
 
 extern "C" {
 #ifdef XR_USE_OPENXR
-matrix4f getTransformFromPose(const XrPosef pose) {
-    const matrix4f rotation = createFromQuaternion(pose.orientation.x, pose.orientation.y,
-                                                   pose.orientation.z, pose.orientation.w);
-    const matrix4f translation = createTranslation(pose.position.x, pose.position.y,
-                                                   pose.position.z);
-    return multiply(&translation, &rotation);
+cxrVector3 cxrConvertVector(const XrVector3f &v) {
+    return {{v.x, v.y, v.z}};
 }
 
-cxrMatrix34 cxrConvert(const matrix4f &m) {
-    cxrMatrix34 out{};
-    // The matrices are compatible so doing a memcpy() here
-    //  noting that we are a [3][4] and ovr uses [4][4]
-    memcpy(&out, &m, sizeof(out));
-    return out;
+// Everything but deviceToAbsoluteTracking, which is converted for all devices at once.
+void updateDevicePose(const ssnwt::DevicePose &device, cxrTrackedDevicePose *pose) {
+    pose->velocity = cxrConvertVector(device.linearVelocity);
+    pose->angularVelocity = cxrConvertVector(device.angularVelocity);
+    pose->poseIsValid = cxrTrue;
+    pose->deviceIsConnected = cxrTrue;
+    pose->trackingResult = cxrTrackingResult_Running_OK;
 }
 
-void updateTrackingState(cxrVRTrackingState *trackingState) {
-    XrSpaceLocation location;
+void locateTrackingState(cxrVRTrackingState *trackingState, ssnwt::PoseSample *measured) {
     cxrVRTrackingState TrackingState = {};
-    // hmd
-    if (pOpenXr->getLocateSpace(&location) == XR_SUCCESS) {
-        TrackingState.hmd.pose.deviceToAbsoluteTracking =
-                cxrConvert(getTransformFromPose(location.pose));
-        TrackingState.hmd.pose.poseIsValid = cxrTrue;
-        TrackingState.hmd.pose.deviceIsConnected = cxrTrue;
-        TrackingState.hmd.pose.trackingResult = cxrTrackingResult_Running_OK;
+    const bool actionsSynced = pOpenXr->syncAction() == XR_SUCCESS;
+    ssnwt::PoseSample sample{};
+    pOpenXr->locateDevices(&sample, measured);
+    TrackingState.poseTimeOffset = pOpenXr->getPoseTimeOffset();
+    std::array<ssnwt::ControllerState, Side::COUNT> controllerStates{};
+    const bool controllersSampled =
+            actionsSynced && pOpenXr->getControllerStates(&controllerStates) == XR_SUCCESS;
+    // hmd, left/right controller
+    cxrTrackedDevicePose *devicePoses[Device::COUNT] = {&TrackingState.hmd.pose,
+                                                        &TrackingState.controller[0].pose,
+                                                        &TrackingState.controller[1].pose};
+    XrPosef poses[Device::COUNT];
+    cxrMatrix34 *matrices[Device::COUNT];
+    size_t poseCount = 0;
+    for (int device = 0; device < Device::COUNT; device++) {
+        if (!sample.devices[device].valid) continue;
+        if (device != Device::HMD && !controllersSampled) continue;
+        updateDevicePose(sample.devices[device], devicePoses[device]);
+        poses[poseCount] = sample.devices[device].pose;
+        matrices[poseCount++] = &devicePoses[device]->deviceToAbsoluteTracking;
     }
-    // left/right controller
-    if (pOpenXr->syncAction() == XR_SUCCESS) {
+    ssnwt::posesToMatrix34(poses, matrices, poseCount);
+    if (controllersSampled) {
         for (uint32_t eye = 0; eye < CXR_NUM_CONTROLLERS; eye++) {
-            if (pOpenXr->getControllerSpace(eye, &location) == XR_SUCCESS) {
-                TrackingState.controller[eye].pose.deviceToAbsoluteTracking =
-                        cxrConvert(getTransformFromPose(location.pose));
-
-                TrackingState.controller[eye].booleanComps = lastBooleanComps;
-                pOpenXr->getControllerState(eye, &TrackingState.controller[eye].booleanComps,
-                                            &TrackingState.controller[eye].booleanCompsChanged,
-                                            TrackingState.controller[eye].scalarComps);
-                lastBooleanComps = TrackingState.controller[eye].booleanComps;
-                TrackingState.controller[eye].pose.poseIsValid = cxrTrue;
-                TrackingState.controller[eye].pose.deviceIsConnected = cxrTrue;
-                TrackingState.controller[eye].pose.trackingResult = cxrTrackingResult_Running_OK;
-            }
+            if (!TrackingState.controller[eye].pose.poseIsValid) continue;
+            TrackingState.controller[eye].booleanComps = controllerStates[eye].booleanComps;
+            memcpy(TrackingState.controller[eye].scalarComps,
+                   controllerStates[eye].scalarComps,
+                   sizeof(TrackingState.controller[eye].scalarComps));
         }
     }
     if (trackingState != nullptr) {
@@ -94,38 +123,138 @@ void updateTrackingState(cxrVRTrackingState *trackingState) {
 }
 
 void onDraw(uint32_t eye) {
-    if (pGraphicRender) pGraphicRender->draw(eye);
+#ifdef XR_USE_CLOUDXR
+    if (directBlit) {
+        if (pLatchedFrames) pCloudXr->render(eye, *pLatchedFrames);
+        return;
+    }
+#endif // XR_USE_CLOUDXR
+    if (!pGraphicRender) return;
+    float warp[9];
+    if (eye == ssnwt::ALL_VIEWS) {
+        for (uint32_t view = 0; view < 2; view++) {
+            pGraphicRender->setWarp(view, pOpenXr->getViewWarp(view, warp) ? warp : nullptr);
+        }
+        pGraphicRender->drawMultiview();
+        return;
+    }
+    pGraphicRender->setWarp(eye, pOpenXr->getViewWarp(eye, warp) ? warp : nullptr);
+    pGraphicRender->draw(eye);
 }
 #elif XR_USE_CLOUDXR
 float angleY = 0;
-matrix4f getTransformFromPose() {
+cxrMatrix34 getTransformFromPose() {
     angleY += 0.001;
     if (angleY > 2 * M_PI) angleY = 0;
-    const matrix4f rotation = rotationY(angleY);
-    const matrix4f translation = createTranslation(0, 0, 0);
-    return multiply(&translation, &rotation);
+    return ssnwt::poseToMatrix34(ssnwt::quaternionFromYaw(angleY), {0, 0, 0});
 }
 
-cxrMatrix34 cxrConvert(const matrix4f &m) {
-    cxrMatrix34 out{};
-    // The matrices are compatible so doing a memcpy() here
-    //  noting that we are a [3][4] and ovr uses [4][4]
-    memcpy(&out, &m, sizeof(out));
-    return out;
-}
-void updateTrackingState(cxrVRTrackingState *trackingState) {
+void locateTrackingState(cxrVRTrackingState *trackingState, ssnwt::PoseSample *measured) {
     cxrVRTrackingState TrackingState = {};
     TrackingState.hmd.pose.deviceToAbsoluteTracking =
-            cxrConvert(getTransformFromPose());
+            getTransformFromPose();
     TrackingState.hmd.pose.poseIsValid = cxrTrue;
     TrackingState.hmd.pose.deviceIsConnected = cxrTrue;
     TrackingState.hmd.pose.trackingResult = cxrTrackingResult_Running_OK;
+    const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    ssnwt::trackingStateToSample(now, TrackingState, measured);
     if (trackingState != nullptr) {
         *trackingState = TrackingState;
     }
 }
 #endif // XR_USE_OPENXR
 
+#ifdef XR_USE_CLOUDXR
+// Replayed poses win over live tracking, and whatever is sent gets recorded.
+void updateTrackingState(cxrVRTrackingState *trackingState) {
+    cxrVRTrackingState TrackingState = {};
+    ssnwt::PoseSample measured{};
+    ssnwt::PoseTraceRecord record;
+    if (poseReplay.isOpen() && poseReplay.next(&record)) {
+        TrackingState = record.state;
+        measured = record.measured;
+    } else {
+        locateTrackingState(&TrackingState, &measured);
+    }
+    if (poseRecorder.isOpen()) {
+        const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        if (!poseRecorder.append(now, TrackingState, measured)) {
+            ALOGE("[main]Pose recording stopped after %zu states", poseRecorder.getCount());
+            poseRecorder.close();
+        }
+    }
+    if (trackingState != nullptr) {
+        *trackingState = TrackingState;
+    }
+}
+
+void openPoseTrace(const ::CloudXR::ClientOptions &options) {
+    if (!options.mPoseRecordPath.empty() && !poseRecorder.isOpen()) {
+        if (poseRecorder.open(options.mPoseRecordPath.c_str())) {
+            ALOGD("[main]Recording poses to %s", options.mPoseRecordPath.c_str());
+        } else {
+            ALOGE("[main]Failed to record poses to %s", options.mPoseRecordPath.c_str());
+        }
+    }
+    if (!options.mPoseReplayPath.empty() && !poseReplay.isOpen()) {
+        if (poseReplay.open(options.mPoseReplayPath.c_str())) {
+            ALOGD("[main]Replaying %zu poses from %s", poseReplay.getCount(),
+                  options.mPoseReplayPath.c_str());
+            poseReplay.setLoop(true);
+        } else {
+            ALOGE("[main]Failed to replay poses from %s", options.mPoseReplayPath.c_str());
+        }
+    }
+}
+
+void closePoseTrace() {
+    poseRecorder.close();
+    poseReplay.close();
+}
+
+// Before the receiver it latches from goes away.
+void stopLatchThread() {
+    latchThread.stop();
+    if (pGraphicRender) pGraphicRender->setSourceTextures(0, 0);
+}
+
+// Starts latching again for the current receiver, if the latch thread is wanted at all.
+void startLatchThread(const ssnwt::EGLHelper &eglHelper) {
+    if (!pCloudXr->getOptions().mLatchThread) return;
+    latchThread.start(pCloudXr, eglHelper, (int32_t) pCloudXr->getDesc().width,
+                      (int32_t) pCloudXr->getDesc().height);
+}
+
+// Mostly runs on a CloudXR thread.
+void onConnectionStateChanged(ssnwt::ConnectionState state) {
+    renderSignal.post(RenderEvent_ClientStateChanged);
+}
+
+// Only a receiver the server dropped, or one for another size, costs a handshake.
+void resumeOrConnect() {
+    if (pCloudXr->resume(mSurfaceWidth, mSurfaceHeight)) return;
+    pCloudXr->disconnect();
+    pCloudXr->connect(hmdInfo.cmdLine, mSurfaceWidth, mSurfaceHeight,
+                      hmdInfo.fovX, hmdInfo.fovY,
+                      hmdInfo.ipd, hmdInfo.predOffset, 1, 1, hmdInfo.fps,
+                      updateTrackingState, nullptr, nullptr, onConnectionStateChanged);
+}
+#endif // XR_USE_CLOUDXR
+
+// Blocks the gl thread until one of the RenderEvents is posted.
+void waitRenderEvent() {
+    const uint32_t events = renderSignal.wait();
+    ALOGV("[main]render events 0x%x", events);
+}
+
+// Same, but wakes up by deadline at the latest.
+void waitRenderEventUntil(std::chrono::steady_clock::time_point deadline) {
+    const uint32_t events = renderSignal.waitUntil(deadline);
+    ALOGV("[main]render events 0x%x", events);
+}
+
 void gl_main() {
     ALOGD("[main]+++++ Enter gl thread +++++");
     ssnwt::EGLHelper eglHelper{};
@@ -134,82 +263,192 @@ void gl_main() {
     eglHelper.setSurface();
     pOpenXr->initialize(onDraw);
 #else
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    while (!quit && pNativeWindow == nullptr) waitRenderEvent();
     eglHelper.setSurface(pNativeWindow);
 #endif
 
 #ifdef XR_USE_CLOUDXR
     ssnwt::CloudXR cloudXr{};
     cxrFramesLatched framesLatched;
+    pCloudXr = &cloudXr;
+    bool wasPaused = false;
 #endif // XR_USE_CLOUDXR
     while (!quit && pGraphicRender) {
         if (paused || pNativeWindow == nullptr) {
             ALOGW("[main]Already paused, so do not render.");
+            frameAllocations.reset();
 #ifdef XR_USE_CLOUDXR
-            cloudXr.disconnect();
+            wasPaused = true;
+            stopLatchThread();
+            if (!cloudXr.isSuspended()) {
+                cloudXr.suspend();
+            } else if (std::chrono::steady_clock::now() >= cloudXr.getSuspendDeadline()) {
+                ALOGD("[main]Paused for too long, disconnecting");
+                cloudXr.disconnect();
+            }
+            // Taking the headset off and on again is part of the recording, only a stream
+            // that is really gone ends it.
+            if (!cloudXr.isSuspended()) closePoseTrace();
+#ifdef XR_USE_OPENXR
+            pOpenXr->onStreamStopped();
+#endif // XR_USE_OPENXR
+            if (cloudXr.isSuspended()) {
+                waitRenderEventUntil(cloudXr.getSuspendDeadline());
+                continue;
+            }
 #endif // XR_USE_CLOUDXR
-            std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+            // Resume, a new surface or quit wakes us up.
+            waitRenderEvent();
             continue;
         }
+#ifdef XR_USE_CLOUDXR
+        // Back on the same surface, the surface change below would have brought the stream
+        // back otherwise. The receiver is suspended or, after the deadline, gone.
+        if (wasPaused && !isSurfaceChanged) {
+            frameAllocations.reset();
+            resumeOrConnect();
+            openPoseTrace(cloudXr.getOptions());
+            startLatchThread(eglHelper);
+        }
+        wasPaused = false;
+#endif // XR_USE_CLOUDXR
         if (isSurfaceChanged) {
             isSurfaceChanged = false;
+            frameAllocations.reset();
 #ifdef XR_USE_CLOUDXR
-            cloudXr.connect(hmdInfo.cmdLine, mSurfaceWidth, mSurfaceHeight,
-                            hmdInfo.fovX, hmdInfo.fovY,
-                            hmdInfo.ipd, hmdInfo.predOffset, 1, 1, hmdInfo.fps,
-                            updateTrackingState, nullptr, nullptr);
+            stopLatchThread();
+            resumeOrConnect();
+            openPoseTrace(cloudXr.getOptions());
+#ifdef XR_USE_OPENXR
+            pOpenXr->setPoseTimeMode(cloudXr.getOptions().mPredictDisplayTime
+                                     ? ssnwt::PoseTimeMode::PredictedDisplay
+                                     : ssnwt::PoseTimeMode::Lookahead);
+            pOpenXr->setButtonDebounce(cloudXr.getOptions().mButtonDebounce);
+            pOpenXr->setPredictionModel(
+                    static_cast<ssnwt::PredictionModel>(cloudXr.getOptions().mPosePredictor));
+            pOpenXr->setStreamProjection(cloudXr.getDesc().proj);
+            const auto reprojection =
+                    static_cast<ssnwt::Reprojection>(cloudXr.getOptions().mReprojection);
+            pOpenXr->setReprojection(reprojection);
+            directBlit = reprojection != ssnwt::Reprojection::Shader &&
+                         !cloudXr.getOptions().mLatchThread;
+#endif // XR_USE_OPENXR
 #endif // XR_USE_CLOUDXR
 #ifdef XR_USE_OPENXR
             pOpenXr->setSurface(pNativeWindow);
 #endif // XR_USE_OPENXR
             eglHelper.setSurface(pNativeWindow);
             ALOGD("[main]window (%d, %d)", mSurfaceWidth, mSurfaceHeight);
+#ifdef XR_USE_CLOUDXR
+            // The direct path never touches GraphicRender's textures, so don't allocate them.
+            if (!directBlit) pGraphicRender->initialize(mSurfaceWidth, mSurfaceHeight);
+#ifdef XR_USE_OPENXR
+            // Only the shader path draws itself, cxrBlitFrame still goes one eye at a time.
+            pOpenXr->setMultiview(!directBlit && cloudXr.getOptions().mMultiview &&
+                                  pGraphicRender->initializeMultiview());
+#endif // XR_USE_OPENXR
+            startLatchThread(eglHelper);
+#else
             pGraphicRender->initialize(mSurfaceWidth, mSurfaceHeight);
+#endif // XR_USE_CLOUDXR
         }
 
         if (!eglHelper.isValid()) {
             ALOGW("[main]EGL is not valid, so do not render.");
-            std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+            // Only a new surface or a pause can change that.
+            waitRenderEvent();
+            continue;
+        }
+#ifdef XR_USE_CLOUDXR
+        if (cloudXr.isReconnectDue()) {
+            stopLatchThread();
+            cloudXr.reconnect();
+            startLatchThread(eglHelper);
+            frameAllocations.reset();
+        }
+#ifndef XR_USE_OPENXR
+        // Without an OpenXR runtime asking for frames there is nothing to draw until the
+        // stream starts.
+        if (!cloudXr.isStreaming()) {
+            if (cloudXr.getConnectionState() == ssnwt::ConnectionState::Recovering) {
+                waitRenderEventUntil(cloudXr.getReconnectTime());
+            } else {
+                waitRenderEvent();
+            }
             continue;
         }
+#endif // XR_USE_OPENXR
+#endif // XR_USE_CLOUDXR
         ssnwt::frameStart();
+        frameAllocations.frameStart();
         ssnwt::GraphicRender::clear();
+#ifdef XR_USE_OPENXR
+        // xrWaitFrame can block for most of a vsync, latch only once it has returned.
+        pOpenXr->waitFrame();
+        pOpenXr->beginFrame();
+#endif // XR_USE_OPENXR
 #ifdef XR_USE_CLOUDXR
-        bool cloudxrPrepared = cloudXr.preRender(&framesLatched) == cxrError_Success;
+        cloudXr.sampleTrackingState();
+        bool cloudxrPrepared = false;
+        if (latchThread.isRunning()) {
+            // The latch thread already copied the frame, only switch to its textures.
+            ssnwt::LatchedTexture latched;
+            if (latchThread.acquire(&latched)) {
+                pGraphicRender->setSourceTextures(latched.textures[0], latched.textures[1]);
+#ifdef XR_USE_OPENXR
+                pOpenXr->onFrameLatched(latched.poseMatrix);
+#endif // XR_USE_OPENXR
+            }
+        } else {
+            cloudxrPrepared = cloudXr.preRender(&framesLatched) == cxrError_Success;
+#ifdef XR_USE_OPENXR
+            if (cloudxrPrepared) pOpenXr->onFrameLatched(framesLatched.poseMatrix);
+#endif // XR_USE_OPENXR
+        }
+        pLatchedFrames = cloudxrPrepared ? &framesLatched : nullptr;
 #endif // XR_USE_CLOUDXR
         for (int32_t eye = 0; eye < 2; eye++) {
-            if (pGraphicRender->setupFrameBuffer(eye)) {
 #ifdef XR_USE_CLOUDXR
-                if (cloudxrPrepared) cloudXr.render(eye, framesLatched);
-#else
-                ssnwt::GraphicRender::clear(eye);
+            if (directBlit) break;
 #endif // XR_USE_CLOUDXR
+#ifdef XR_USE_CLOUDXR
+            // Without a newly latched frame the eye texture keeps the last one, a repeated
+            // frame draws it again. With the latch thread it is never drawn at all.
+            if (cloudxrPrepared && pGraphicRender->setupFrameBuffer(eye)) {
+                cloudXr.render(eye, framesLatched);
             }
+#else
+            if (pGraphicRender->setupFrameBuffer(eye)) ssnwt::GraphicRender::clear(eye);
+#endif // XR_USE_CLOUDXR
             ssnwt::GraphicRender::bindDefaultFrameBuffer();
 #ifndef XR_USE_OPENXR
             if (pGraphicRender) pGraphicRender->draw(eye);
 #endif // XR_USE_OPENXR
         }
 #ifdef XR_USE_CLOUDXR
-        if (cloudxrPrepared) cloudXr.postRender(framesLatched);
+        if (cloudxrPrepared && !directBlit) cloudXr.postRender(framesLatched);
 #endif // XR_USE_CLOUDXR
 
 #ifdef XR_USE_OPENXR
-        pOpenXr->render();
+        pOpenXr->endFrame();
 #else
         eglHelper.swapBuffers();
 #endif // XR_USE_OPENXR
-
-        ssnwt::frameEnd();
 #ifdef XR_USE_CLOUDXR
-        if (!cloudxrPrepared) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(1000));
-        }
+        // The direct path blits from inside endFrame(), release the frame after it.
+        if (cloudxrPrepared && directBlit) cloudXr.postRender(framesLatched);
+        pLatchedFrames = nullptr;
 #endif // XR_USE_CLOUDXR
+
+        ssnwt::frameEnd();
+        frameAllocations.frameEnd();
     }
 #ifdef XR_USE_CLOUDXR
     ALOGD("[main]cloudXr.disconnect()");
+    stopLatchThread();
     cloudXr.disconnect();
+    closePoseTrace();
+    pCloudXr = nullptr;
 #endif // XR_USE_CLOUDXR
 
 #ifdef XR_USE_OPENXR
@@ -252,21 +491,25 @@ Java_com_ssnwt_cloudvr_CloudXR_setSurface(JNIEnv *env, jclass clazz, jobject sur
     mSurfaceHeight = height;
     pNativeWindow = ANativeWindow_fromSurface(env, surface);
     ALOGD("[main]setSurface gNativeWindow=%p", pNativeWindow);
+    renderSignal.post(RenderEvent_SurfaceChanged);
 }
 JNIEXPORT void JNICALL
 Java_com_ssnwt_cloudvr_CloudXR_resume(JNIEnv *env, jclass clazz) {
     ALOGD("[main]Resume");
     paused = false;
+    renderSignal.post(RenderEvent_Resume);
 }
 JNIEXPORT void JNICALL
 Java_com_ssnwt_cloudvr_CloudXR_pause(JNIEnv *env, jclass clazz) {
     ALOGD("[main]Pause");
     pNativeWindow = nullptr;
     paused = true;
+    renderSignal.post(RenderEvent_Pause);
 }
 JNIEXPORT void JNICALL
 Java_com_ssnwt_cloudvr_CloudXR_release(JNIEnv *env, jclass thiz) {
     ALOGD("[main]Release");
     quit = true;
+    renderSignal.post(RenderEvent_Quit);
 }
 }
\ No newline at end of file
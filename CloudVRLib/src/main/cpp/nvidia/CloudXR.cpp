@@ -38,20 +38,51 @@ const char *StateReasonEnumToString(cxrStateReason reason) {
 #undef CASE
 
 namespace ssnwt {
+    // A latch returning faster than this took a frame that was already decoded.
+    constexpr std::chrono::microseconds QUEUED_LATCH_TIME{500};
+
+    static int64_t getTimeNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
     cxrError CloudXR::connect(const char *cmdLine,
                               uint32_t width, uint32_t height, uint32_t fovX, uint32_t fovY,
                               float ipd, float predOffset,
                               float playAreaX, float playAreaZ, uint32_t fps,
                               update_tracking_state_call_back tracking_state_cb,
                               trigger_haptic_call_back trigger_haptic_cb,
-                              receive_user_data_call_back receive_user_data_cb) {
+                              receive_user_data_call_back receive_user_data_cb,
+                              connection_state_call_back connection_state_cb) {
         updateTrackingStateCallBack = tracking_state_cb;
         triggerHapticCallBack = trigger_haptic_cb;
         receiveUserDataCallBack = receive_user_data_cb;
+        connectionStateCallBack = connection_state_cb;
         GOptions.ParseString(cmdLine);
+        for (auto &input : sampledInput) input.reset();
+        packetEdges.reset();
+        posePollPolicy.reset();
+        queueStats = {};
+        firstFrameWaitStart = std::chrono::steady_clock::now();
+        firstFrameReconnected = true;
         ALOGV("[CloudXR]mServerIP %s", GOptions.mServerIP.c_str());
         deviceDesc = getDeviceDesc(width, height, fovX, fovY, ipd, predOffset,
                                    playAreaX, playAreaZ, fps);
+        latchTimeoutMs = GOptions.mLatchTimeoutMs >= 0 ? (uint32_t) GOptions.mLatchTimeoutMs
+                                                       : getLatchTimeoutMs(fps);
+        ALOGD("[CloudXR]latch timeout %d ms", latchTimeoutMs);
+        connection.start(getTimeNs());
+        const cxrError err = createReceiver();
+        if (err != cxrError_Success) {
+            disconnect();
+            return err;
+        }
+        delete pAudioRender;
+        pAudioRender = new AudioRender();
+        return cxrError_Success; //true
+    }
+
+    cxrError CloudXR::createReceiver() {
         cxrClientCallbacks callbacks = getClientCallbacks();
         cxrGraphicsContext context{cxrGraphicsContext_GLES};
         context.egl.display = eglGetCurrentDisplay();
@@ -82,20 +113,52 @@ namespace ssnwt {
         if (err != cxrError_Success) {
             ALOGE("[CloudXR]Failed to connect to CloudXR server at %s. Error %d, %s.",
                   GOptions.mServerIP.c_str(), (int) err, cxrErrorString(err));
-            disconnect();
             return err;
         } else {
             ALOGV("[CloudXR]Receiver created for server: %s", GOptions.mServerIP.c_str());
         }
-        delete pAudioRender;
-        pAudioRender = new AudioRender();
         return cxrError_Success; //true
     }
 
+    void CloudXR::destroyReceiver() {
+        if (receiverHandle != nullptr) {
+            cxrDestroyReceiver(receiverHandle);
+            receiverHandle = nullptr;
+        }
+        clientState = cxrClientState_ReadyToConnect;
+    }
+
+    bool CloudXR::isReconnectDue() const {
+        return connection.isRetryDue(getTimeNs());
+    }
+
+    cxrError CloudXR::reconnect() {
+        destroyReceiver();
+        connection.retry();
+        const connection_state_call_back callBack = connectionStateCallBack;
+        if (callBack) callBack(connection.getState());
+        firstFrameWaitStart = std::chrono::steady_clock::now();
+        firstFrameReconnected = true;
+        const cxrError err = createReceiver();
+        if (err != cxrError_Success) {
+            // Counts as a failed attempt, the backoff goes on.
+            updateClientState(cxrClientState_ConnectionAttemptFailed, cxrStateReason_NetworkError);
+        }
+        return err;
+    }
+
+    std::chrono::steady_clock::time_point CloudXR::getReconnectTime() const {
+        return std::chrono::steady_clock::time_point(
+                std::chrono::nanoseconds(connection.getRetryTimeNs()));
+    }
+
     cxrError CloudXR::disconnect() {
         updateTrackingStateCallBack = nullptr;
         triggerHapticCallBack = nullptr;
         receiveUserDataCallBack = nullptr;
+        connectionStateCallBack = nullptr;
+        suspended = false;
+        connection.stop();
         if (pAudioRender != nullptr) {
             // 作用域为当前函数
             std::lock_guard<std::mutex> lockGuard(audioMutex);
@@ -103,35 +166,123 @@ namespace ssnwt {
             pAudioRender = nullptr;
         }
         ALOGE("[CloudXR]disconnect");
-        if (receiverHandle != nullptr) {
-            cxrDestroyReceiver(receiverHandle);
-            receiverHandle = nullptr;
-        }
+        destroyReceiver();
         return cxrError_Success; //true
     }
 
+    void CloudXR::suspend() {
+        if (receiverHandle == nullptr || suspended) return;
+        if (GOptions.mSuspendTimeoutS == 0) {
+            disconnect();
+            return;
+        }
+        suspended = true;
+        suspendTime = std::chrono::steady_clock::now();
+        {
+            std::lock_guard<std::mutex> lockGuard(audioMutex);
+            delete pAudioRender;
+            pAudioRender = nullptr;
+        }
+        // Nothing samples new poses meanwhile, the poll thread keeps sending this one.
+        cxrVRTrackingState trackingState{};
+        trackingSnapshot.load(&trackingState);
+        trackingState.hmd.activityLevel = cxrDeviceActivityLevel_Idle;
+        trackingSnapshot.store(trackingState);
+        ALOGD("[CloudXR]suspended for up to %u s", GOptions.mSuspendTimeoutS);
+    }
+
+    bool CloudXR::resume(uint32_t dispW, uint32_t dispH) {
+        const bool wasSuspended = suspended;
+        suspended = false;
+        if (receiverHandle == nullptr) return false;
+        // A recovering connection carries on with its retries.
+        const ConnectionState state = connection.getState();
+        if (state == ConnectionState::Idle || state == ConnectionState::Failed) {
+            ALOGW("[CloudXR]connection is %s, reconnecting", ConnectionStateToString(state));
+            return false;
+        }
+        if (dispW / 2 != deviceDesc.width || dispH != deviceDesc.height) {
+            ALOGD("[CloudXR]display size changed, reconnecting");
+            return false;
+        }
+        if (wasSuspended) {
+            std::lock_guard<std::mutex> lockGuard(audioMutex);
+            if (pAudioRender == nullptr) pAudioRender = new AudioRender();
+        }
+        posePollPolicy.reset();
+        firstFrameWaitStart = std::chrono::steady_clock::now();
+        firstFrameReconnected = false;
+        ALOGD("[CloudXR]resumed the connected receiver");
+        return true;
+    }
+
+    std::chrono::steady_clock::time_point CloudXR::getSuspendDeadline() const {
+        return suspendTime + std::chrono::seconds(GOptions.mSuspendTimeoutS);
+    }
+
     cxrError CloudXR::preRender(cxrFramesLatched *framesLatched) {
+        return preRender(framesLatched, latchTimeoutMs);
+    }
+
+    cxrError CloudXR::preRender(cxrFramesLatched *framesLatched, uint32_t timeoutMs) {
+        // Called every display frame, the connection state changes are logged where they happen.
         if (!receiverHandle) {
-            ALOGE("[CloudXR]receiverHandle is null");
             return cxrError_Receiver_Invalid;
         }
         if (clientState != cxrClientState_StreamingSessionInProgress) {
-            ALOGE("[CloudXR]receiverHandle is cxrError_Streamer_Not_Ready %s",
-                  ClientStateEnumToString(clientState));
             return cxrError_Streamer_Not_Ready;
         }
 
-        const uint32_t timeoutMs = 500;
+        const auto latchStart = std::chrono::steady_clock::now();
         cxrError frameErr = cxrLatchFrame(receiverHandle, framesLatched,
                                           cxrFrameMask_All, timeoutMs);
+        updateQueueStats(frameErr, std::chrono::steady_clock::now() - latchStart);
+        if (frameErr == cxrError_Frame_Not_Ready) {
+            return frameErr;
+        }
         bool frameValid = (frameErr == cxrError_Success);
         if (!frameValid) {
             ALOGE("[CloudXR]Error in LatchFrame [%0d] = %s", frameErr, cxrErrorString(frameErr));
             return cxrError_Frame_Invalid;
         }
+        if (firstFrameWaitStart.time_since_epoch().count() != 0) {
+            const auto waitMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - firstFrameWaitStart).count();
+            ALOGD("[CloudXR]first frame %lld ms after %s", (long long) waitMs,
+                  firstFrameReconnected ? "connecting" : "resuming");
+            firstFrameWaitStart = {};
+        }
         return cxrError_Success; //true
     }
 
+    void CloudXR::updateQueueStats(cxrError latchErr, std::chrono::nanoseconds latchTime) {
+        // The SDK doesn't expose its queue, a latch that returns at once found a frame waiting.
+        if (latchErr == cxrError_Frame_Not_Ready) {
+            queueStats.empty++;
+        } else if (latchErr == cxrError_Success) {
+            if (latchTime < QUEUED_LATCH_TIME) {
+                queueStats.queued++;
+            } else {
+                queueStats.waited++;
+            }
+        }
+        const auto now = std::chrono::steady_clock::now();
+        if (queueStats.logTime.time_since_epoch().count() == 0) queueStats.logTime = now;
+        if (now - queueStats.logTime < std::chrono::seconds(1)) return;
+        const uint32_t latched = queueStats.queued + queueStats.waited;
+        ALOGD("[CloudXR]client queue: %u frames latched, %u already queued (%.0f%%), "
+              "%u waited for, %u latches found it empty",
+              latched, queueStats.queued,
+              latched > 0 ? 100.0 * queueStats.queued / latched : 0.0,
+              queueStats.waited, queueStats.empty);
+        queueStats = {};
+        queueStats.logTime = now;
+    }
+
+    uint32_t CloudXR::getLatchTimeoutMs(uint32_t fps) {
+        return fps > 0 ? 1000 / (4 * fps) : 0;
+    }
+
     cxrError CloudXR::render(uint32_t eye, cxrFramesLatched framesLatched) {
         cxrBlitFrame(receiverHandle, &framesLatched, static_cast<uint32_t>(1 << eye));
         return cxrError_Success; //true
@@ -168,13 +319,23 @@ namespace ssnwt {
         desc.predOffset = predOffset;
         desc.receiveAudio = static_cast<cxrBool>(GOptions.mReceiveAudio);
         desc.sendAudio = static_cast<cxrBool>(GOptions.mSendAudio);
-        desc.posePollFreq = 0;
-        desc.disablePosePrediction = cxrFalse;
+        desc.posePollFreq = GOptions.mPosePollFreq != 0 ? GOptions.mPosePollFreq
+                                                        : PosePollPolicy::getPollFrequency(fps);
+        ALOGD("[CloudXR]pose poll %d Hz", desc.posePollFreq);
+        // A client-side predictor already extrapolates the poses it sends.
+        desc.disablePosePrediction = GOptions.mPosePredictor != 0 ? cxrTrue : cxrFalse;
+        // XrSpaceVelocity (and our finite-difference fallback) reports angular velocity
+        // in the base space, not relative to the device.
         desc.angularVelocityInDeviceSpace = cxrFalse;
         desc.foveatedScaleFactor = static_cast<uint32_t>((GOptions.mFoveation < 100)
                                                          ? GOptions.mFoveation : 0);
         // if we have touch controller use Oculus type, else use Vive as more close to 3dof remotes
         desc.ctrlType = cxrControllerType_OculusTouch;
+        // Both stay at the SDK defaults without a latency preset.
+        desc.maxClientQueueSize = GOptions.mMaxClientQueueSize;
+        desc.disableVVSync = GOptions.mDisableVVSync ? cxrTrue : cxrFalse;
+        ALOGD("[CloudXR]client queue %.0f frames, VVSync %s", desc.maxClientQueueSize,
+              desc.disableVVSync ? "off" : "on");
 
         const float halfFOVTanX = tanf(static_cast<float>(M_PI / 360.f * fovX));
         const float halfFOVTanY = tanf(static_cast<float>(M_PI / 360.f * fovY));
@@ -219,13 +380,36 @@ namespace ssnwt {
         return callbacks;
     }
 
-    void CloudXR::getTrackingState(cxrVRTrackingState *trackingState) {
-//        std::lock_guard<std::mutex> lockGuard(cloudMutex);
+    void CloudXR::sampleTrackingState() {
         if (updateTrackingStateCallBack) {
-            updateTrackingStateCallBack(trackingState);
+            cxrVRTrackingState trackingState{};
+            updateTrackingStateCallBack(&trackingState);
+            const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count();
+            const bool moving = posePollPolicy.update(now, &trackingState);
+            bool inputChanged = false;
+            for (uint32_t i = 0; i < CXR_NUM_CONTROLLERS; i++) {
+                inputChanged |= sampledInput[i].hasChanged(trackingState.controller[i]);
+                sampledInput[i].update(trackingState.controller[i]);
+            }
+            const uint32_t version = trackingSnapshot.store(trackingState);
+            // Fast head motion and new controller input are not left waiting for the next
+            // poll. A still head with unchanged controllers is, the poll sends it anyway.
+            if (GOptions.mPushPoses && receiverHandle &&
+                clientState == cxrClientState_StreamingSessionInProgress &&
+                (moving || inputChanged) && packetEdges.claim(version, &trackingState)) {
+                cxrSendPose(receiverHandle, &trackingState);
+            }
         }
     }
 
+    void CloudXR::getTrackingState(cxrVRTrackingState *trackingState) {
+        // Runs on the SDK pose poll thread, so never touch the OpenXR session from here. The
+        // SDK sends whatever we return, a copy of the newest snapshot with its edges. Only
+        // loads again when the XR thread pushed a newer one in between.
+        while (!packetEdges.claim(trackingSnapshot.load(trackingState), trackingState)) {}
+    }
+
     void CloudXR::triggerHaptic(const cxrHapticFeedback *hapticFeedback) {
         if (triggerHapticCallBack) triggerHapticCallBack(hapticFeedback);
     }
@@ -252,6 +436,9 @@ namespace ssnwt {
         ALOGD("[CloudXR]updateClientState state:%s, reason:%s",
               ClientStateEnumToString(state), StateReasonEnumToString(reason));
         clientState = state;
+        if (!connection.update(state, reason, getTimeNs())) return;
+        const connection_state_call_back callBack = connectionStateCallBack;
+        if (callBack) callBack(connection.getState());
     }
 
 } // end namespace ssnwt
\ No newline at end of file
@@ -1,11 +1,17 @@
 #ifndef CLOUDXRDEMO_CLOUDXR_H
 #define CLOUDXRDEMO_CLOUDXR_H
 
+#include <atomic>
+#include <chrono>
 #include <string>
 #include <thread>
 #include "CloudXRClient.h"
 #include "CloudXRClientOptions.h"
 #include "AudioRender.h"
+#include "SeqLock.h"
+#include "InputTracker.h"
+#include "PosePollPolicy.h"
+#include "ConnectionStateMachine.h"
 
 using namespace std;
 
@@ -16,6 +22,8 @@ namespace ssnwt {
 
     typedef void (*receive_user_data_call_back)(const void *, uint32_t);
 
+    typedef void (*connection_state_call_back)(ConnectionState);
+
     class CloudXR {
     public:
         cxrError connect(const char *cmdLine,
@@ -24,16 +32,57 @@ namespace ssnwt {
                          float playAreaX, float playAreaZ, uint32_t fps,
                          update_tracking_state_call_back tracking_state_cb,
                          trigger_haptic_call_back trigger_haptic_cb,
-                         receive_user_data_call_back receive_user_data_cb);
+                         receive_user_data_call_back receive_user_data_cb,
+                         connection_state_call_back connection_state_cb);
 
         cxrError disconnect();
 
+        // Keeps the receiver connected while nothing is drawn, e.g. with the headset off. The
+        // audio stream is closed and the server is told the device is idle. Disconnects right
+        // away when the suspend timeout is 0.
+        void suspend();
+
+        // Picks the stream back up on the receiver that is still connected for the same display
+        // size. Returns false when there is none or the server dropped it, connect again then.
+        bool resume(uint32_t dispW, uint32_t dispH);
+
+        bool isSuspended() const { return suspended; }
+
+        // When a suspended receiver should be given up.
+        std::chrono::steady_clock::time_point getSuspendDeadline() const;
+
+        // The connection was lost and its backoff is over. Call from the thread that connected,
+        // with its context current, and keep other threads off the receiver meanwhile.
+        bool isReconnectDue() const;
+
+        cxrError reconnect();
+
+        ConnectionState getConnectionState() const { return connection.getState(); }
+
+        // When the pending reconnect is due.
+        std::chrono::steady_clock::time_point getReconnectTime() const;
+
+        // Latches the newest decoded frame, waiting at most the latch timeout for one. Returns
+        // cxrError_Frame_Not_Ready when none arrived in time, the last frame is then repeated.
         cxrError preRender(cxrFramesLatched *framesLatched);
 
+        cxrError preRender(cxrFramesLatched *framesLatched, uint32_t timeoutMs);
+
         cxrError render(uint32_t eye, cxrFramesLatched framesLatched);
 
         cxrError postRender(cxrFramesLatched framesLatched);
 
+        const ::CloudXR::ClientOptions &getOptions() const { return GOptions; }
+
+        bool isStreaming() const {
+            return clientState == cxrClientState_StreamingSessionInProgress;
+        }
+
+        const cxrDeviceDesc &getDesc() const { return deviceDesc; }
+
+        // Sample HMD/controller state on the XR thread and publish it for the pose poll thread.
+        void sampleTrackingState();
+
     private:
 
         cxrDeviceDesc getDeviceDesc(uint32_t dispW, uint32_t dispH,
@@ -41,6 +90,18 @@ namespace ssnwt {
                                     float ipd, float predOffset,
                                     float playAreaX, float playAreaZ, uint32_t fps) const;
 
+        // Default latch timeout, a quarter of the display period. Waiting any longer would
+        // make the frame that gets drawn miss its vsync.
+        static uint32_t getLatchTimeoutMs(uint32_t fps);
+
+        // Per second occupancy of the decoded frame queue, as seen by the latches.
+        void updateQueueStats(cxrError latchErr, std::chrono::nanoseconds latchTime);
+
+        // Creates the receiver for deviceDesc on the current context and starts connecting it.
+        cxrError createReceiver();
+
+        void destroyReceiver();
+
         static cxrClientCallbacks getClientCallbacks();
 
         void getTrackingState(cxrVRTrackingState *trackingState);
@@ -55,15 +116,37 @@ namespace ssnwt {
 
     private:
         cxrDeviceDesc deviceDesc{};
+        uint32_t latchTimeoutMs = 0;
+        bool suspended = false;
+        std::chrono::steady_clock::time_point suspendTime;
+        // Since the stream was asked for, cleared by the first frame latched.
+        std::chrono::steady_clock::time_point firstFrameWaitStart;
+        bool firstFrameReconnected = false;
+        struct {
+            uint32_t queued;    // latched without waiting
+            uint32_t waited;    // latched once a frame arrived
+            uint32_t empty;     // timed out
+            std::chrono::steady_clock::time_point logTime;
+        } queueStats{};
         cxrReceiverHandle receiverHandle = nullptr;
         ::CloudXR::ClientOptions GOptions;
         AudioRender *pAudioRender = nullptr;
-        cxrClientState clientState = cxrClientState_ReadyToConnect;
+        // Set by the SDK's connection thread.
+        std::atomic<cxrClientState> clientState{cxrClientState_ReadyToConnect};
         uint64_t connectionFlags = cxrConnectionFlags_ConnectAsync;
 
         update_tracking_state_call_back updateTrackingStateCallBack{0};
         trigger_haptic_call_back triggerHapticCallBack{0};
         receive_user_data_call_back receiveUserDataCallBack{0};
+        // Read on the SDK thread, cleared by disconnect on the gl thread.
+        std::atomic<connection_state_call_back> connectionStateCallBack{nullptr};
+
+        SeqLock<cxrVRTrackingState> trackingSnapshot;
+        PosePollPolicy posePollPolicy;
+        ConnectionStateMachine connection;
+        // Poses are sent from the poll thread and pushed from the XR thread.
+        PacketEdges packetEdges;
+        std::array<ControllerSampleState, CXR_NUM_CONTROLLERS> sampledInput;
 
         std::mutex audioMutex;
 //        std::mutex cloudMutex;
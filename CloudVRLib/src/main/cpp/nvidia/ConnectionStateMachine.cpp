@@ -0,0 +1,119 @@
+#include <algorithm>
+#include "ConnectionStateMachine.h"
+#include "log.h"
+
+namespace ssnwt {
+    // Wi-Fi roaming drops the connection for a moment, the first retry goes out quickly.
+    constexpr int64_t FIRST_RETRY_NS = 250000000;
+    constexpr int64_t MIN_BACKOFF_NS = 500000000;
+    constexpr int64_t MAX_BACKOFF_NS = 30000000000;
+
+    const char *ConnectionStateToString(ConnectionState state) {
+        switch (state) {
+            case ConnectionState::Idle:
+                return "Idle";
+            case ConnectionState::Connecting:
+                return "Connecting";
+            case ConnectionState::Streaming:
+                return "Streaming";
+            case ConnectionState::Recovering:
+                return "Recovering";
+            case ConnectionState::Failed:
+                return "Failed";
+        }
+        return "";
+    }
+
+    void ConnectionStateMachine::start(int64_t timeNs) {
+        std::lock_guard<std::mutex> lockGuard(mutex);
+        retries = 0;
+        random.seed((uint32_t) timeNs);
+        setState(ConnectionState::Connecting);
+    }
+
+    void ConnectionStateMachine::stop() {
+        std::lock_guard<std::mutex> lockGuard(mutex);
+        setState(ConnectionState::Idle);
+    }
+
+    uint32_t ConnectionStateMachine::getMaxRetries(cxrStateReason reason) {
+        switch (reason) {
+            case cxrStateReason_NetworkError:
+            case cxrStateReason_DisconnectedUnexpected:
+            case cxrStateReason_NoError:
+                return 10;
+            case cxrStateReason_RTSPCannotConnect:
+            case cxrStateReason_HolePunchFailed:
+                // The server may still be starting up, but not for minutes.
+                return 5;
+            default:
+                // Codec, version, feature and authorization problems stay, and an expected
+                // disconnect was the server's choice.
+                return 0;
+        }
+    }
+
+    bool ConnectionStateMachine::update(cxrClientState clientState, cxrStateReason reason,
+                                        int64_t timeNs) {
+        std::lock_guard<std::mutex> lockGuard(mutex);
+        const ConnectionState oldState = state;
+        // A retry is already planned or there is nothing to recover.
+        if (oldState != ConnectionState::Connecting && oldState != ConnectionState::Streaming) {
+            return false;
+        }
+        switch (clientState) {
+            case cxrClientState_ConnectionAttemptInProgress:
+                setState(ConnectionState::Connecting);
+                break;
+            case cxrClientState_StreamingSessionInProgress:
+                retries = 0;
+                setState(ConnectionState::Streaming);
+                break;
+            case cxrClientState_ConnectionAttemptFailed:
+            case cxrClientState_Disconnected:
+                if (reason == cxrStateReason_DisconnectedExpected) {
+                    setState(ConnectionState::Idle);
+                } else if (retries < getMaxRetries(reason)) {
+                    retryTimeNs = timeNs + getBackoffNs();
+                    setState(ConnectionState::Recovering);
+                    ALOGD("[Connection]retry %u in %lld ms", retries + 1,
+                          (long long) ((retryTimeNs - timeNs) / 1000000));
+                } else {
+                    setState(ConnectionState::Failed);
+                }
+                break;
+            case cxrClientState_Exiting:
+                setState(ConnectionState::Idle);
+                break;
+            default:
+                break;
+        }
+        return state != oldState;
+    }
+
+    bool ConnectionStateMachine::isRetryDue(int64_t timeNs) const {
+        return state == ConnectionState::Recovering && timeNs >= retryTimeNs;
+    }
+
+    void ConnectionStateMachine::retry() {
+        std::lock_guard<std::mutex> lockGuard(mutex);
+        retries++;
+        setState(ConnectionState::Connecting);
+    }
+
+    int64_t ConnectionStateMachine::getBackoffNs() {
+        if (retries == 0) return FIRST_RETRY_NS;
+        const int64_t backoffNs = std::min(MIN_BACKOFF_NS << std::min(retries - 1, 6u),
+                                           MAX_BACKOFF_NS);
+        // Anywhere in the upper half, so clients dropped together don't come back together.
+        std::uniform_int_distribution<int64_t> jitter(backoffNs / 2, backoffNs);
+        return jitter(random);
+    }
+
+    void ConnectionStateMachine::setState(ConnectionState newState) {
+        if (state == newState) return;
+        ALOGD("[Connection]%s -> %s", ConnectionStateToString(state),
+              ConnectionStateToString(newState));
+        state = newState;
+    }
+}
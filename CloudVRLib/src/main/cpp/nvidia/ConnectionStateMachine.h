@@ -0,0 +1,66 @@
+//
+// Tracks the CloudXR connection from what the SDK reports and decides when to retry it:
+// exponential backoff with jitter, how often depending on why the connection went away.
+// Knows nothing about the receiver itself, the caller reconnects when a retry is due.
+//
+
+#ifndef CLOUDXRDEMO_CONNECTIONSTATEMACHINE_H
+#define CLOUDXRDEMO_CONNECTIONSTATEMACHINE_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include "CloudXRCommon.h"
+
+namespace ssnwt {
+    enum class ConnectionState {
+        Idle,
+        Connecting,
+        Streaming,
+        Recovering,     // waiting to retry after the connection failed or dropped
+        Failed,         // gave up, only a new connect starts over
+    };
+
+    const char *ConnectionStateToString(ConnectionState state);
+
+    class ConnectionStateMachine {
+    public:
+        // A first cxrConnect was issued.
+        void start(int64_t timeNs);
+
+        // Ignores whatever the receiver being torn down still reports.
+        void stop();
+
+        // Feeds a client state the SDK reported, on its thread. Returns true when the
+        // connection state changed.
+        bool update(cxrClientState clientState, cxrStateReason reason, int64_t timeNs);
+
+        // Recovering and the backoff is over, the caller reconnects and calls retry().
+        bool isRetryDue(int64_t timeNs) const;
+
+        void retry();
+
+        // When the pending retry is due, only meaningful while recovering.
+        int64_t getRetryTimeNs() const { return retryTimeNs; }
+
+        ConnectionState getState() const { return state; }
+
+    private:
+        // How many retries a loss for this reason is worth, 0 when retrying can't help.
+        static uint32_t getMaxRetries(cxrStateReason reason);
+
+        int64_t getBackoffNs();
+
+        void setState(ConnectionState newState);
+
+        std::atomic<ConnectionState> state{ConnectionState::Idle};
+        std::atomic<int64_t> retryTimeNs{0};
+        // update() runs on the SDK thread, everything else on the gl thread.
+        std::mutex mutex;
+        uint32_t retries = 0;       // since the last time streaming started
+        std::minstd_rand random;
+    };
+}
+
+#endif //CLOUDXRDEMO_CONNECTIONSTATEMACHINE_H
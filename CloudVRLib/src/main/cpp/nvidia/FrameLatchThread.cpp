@@ -0,0 +1,184 @@
+#include <chrono>
+#include "FrameLatchThread.h"
+#include "GpuMemory.h"
+#include "log.h"
+
+namespace ssnwt {
+    // Blocking here costs the display nothing, it only bounds how long stop() takes.
+    constexpr uint32_t LATCH_THREAD_TIMEOUT_MS = 50;
+    // Back off while there is no stream to latch from.
+    constexpr uint32_t NOT_STREAMING_SLEEP_MS = 10;
+
+    bool FrameLatchThread::start(CloudXR *cxr, const EGLHelper &shared,
+                                 int32_t w, int32_t h) {
+        stop();
+        eglCreateSync = reinterpret_cast<PFNEGLCREATESYNCKHRPROC>(
+                eglGetProcAddress("eglCreateSyncKHR"));
+        eglDestroySync = reinterpret_cast<PFNEGLDESTROYSYNCKHRPROC>(
+                eglGetProcAddress("eglDestroySyncKHR"));
+        eglClientWaitSync = reinterpret_cast<PFNEGLCLIENTWAITSYNCKHRPROC>(
+                eglGetProcAddress("eglClientWaitSyncKHR"));
+        if (!eglCreateSync || !eglDestroySync || !eglClientWaitSync) {
+            ALOGE("[FrameLatchThread]EGL_KHR_fence_sync unsupported");
+            return false;
+        }
+        egl = EGLHelper();
+        if (!egl.initializeShared(shared)) return false;
+        cloudXr = cxr;
+        width = w;
+        height = h;
+        running = true;
+        thread = std::thread(&FrameLatchThread::run, this);
+        ALOGD("[FrameLatchThread]started, %d x %d per eye", width, height);
+        return true;
+    }
+
+    void FrameLatchThread::stop() {
+        if (!thread.joinable()) return;
+        running = false;
+        thread.join();
+        ALOGD("[FrameLatchThread]stopped");
+    }
+
+    void FrameLatchThread::run() {
+        if (!egl.setSurface() || !createSlots()) {
+            ALOGE("[FrameLatchThread]no GL context, not latching");
+            egl.release();
+            return;
+        }
+        cxrFramesLatched framesLatched;
+        while (running) {
+            const cxrError err = cloudXr->preRender(&framesLatched, LATCH_THREAD_TIMEOUT_MS);
+            if (err == cxrError_Frame_Not_Ready) continue;
+            if (err != cxrError_Success) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(NOT_STREAMING_SLEEP_MS));
+                continue;
+            }
+            Slot *slot = beginWrite();
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffer);
+            glViewport(0, 0, width, height);
+            const GLenum attachment = GL_COLOR_ATTACHMENT0;
+            for (uint32_t eye = 0; eye < 2; eye++) {
+                glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                                       slot->textures[eye], 0);
+                // The blit covers the whole texture.
+                glInvalidateFramebuffer(GL_DRAW_FRAMEBUFFER, 1, &attachment);
+                cloudXr->render(eye, framesLatched);
+            }
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+            slot->poseMatrix = framesLatched.poseMatrix;
+            cloudXr->postRender(framesLatched);
+            slot->writeFence = eglCreateSync(egl.getDisplay(), EGL_SYNC_FENCE_KHR, nullptr);
+            // The render thread only polls the fence, make sure it gets signaled.
+            glFlush();
+            publish(slot);
+        }
+        destroySlots();
+        egl.release();
+    }
+
+    bool FrameLatchThread::createSlots() {
+        glGenFramebuffers(1, &framebuffer);
+        for (Slot &slot : slots) {
+            slot.state = SlotState::Free;
+            slot.writeFence = EGL_NO_SYNC_KHR;
+            slot.readFence = EGL_NO_SYNC_KHR;
+            glGenTextures(2, slot.textures);
+            for (GLuint texture : slot.textures) {
+                glBindTexture(GL_TEXTURE_2D, texture);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+                glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, width, height);
+            }
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
+        GpuMemory::allocated("latch slots", getSlotBytes());
+        return glGetError() == GL_NO_ERROR;
+    }
+
+    void FrameLatchThread::destroySlots() {
+        std::lock_guard<std::mutex> lockGuard(slotMutex);
+        for (Slot &slot : slots) {
+            destroySync(&slot.writeFence);
+            destroySync(&slot.readFence);
+            glDeleteTextures(2, slot.textures);
+            slot = {};
+        }
+        glDeleteFramebuffers(1, &framebuffer);
+        framebuffer = 0;
+        GpuMemory::released("latch slots", getSlotBytes());
+    }
+
+    int64_t FrameLatchThread::getSlotBytes() const {
+        return (int64_t) slots.size() * 2 * width * height * GpuMemory::RGBA8_BYTES;
+    }
+
+    FrameLatchThread::Slot *FrameLatchThread::beginWrite() {
+        Slot *slot = nullptr;
+        EGLSyncKHR readFence;
+        {
+            std::lock_guard<std::mutex> lockGuard(slotMutex);
+            for (Slot &candidate : slots) {
+                if (candidate.state == SlotState::Free) {
+                    slot = &candidate;
+                    break;
+                }
+            }
+            slot->state = SlotState::Writing;
+            readFence = slot->readFence;
+            slot->readFence = EGL_NO_SYNC_KHR;
+        }
+        if (readFence != EGL_NO_SYNC_KHR) {
+            eglClientWaitSync(egl.getDisplay(), readFence, 0, EGL_FOREVER_KHR);
+            destroySync(&readFence);
+        }
+        return slot;
+    }
+
+    void FrameLatchThread::publish(Slot *slot) {
+        std::lock_guard<std::mutex> lockGuard(slotMutex);
+        for (Slot &other : slots) {
+            if (other.state == SlotState::Ready) {
+                // Never picked up, a newer frame replaces it.
+                destroySync(&other.writeFence);
+                other.state = SlotState::Free;
+            }
+        }
+        slot->state = SlotState::Ready;
+    }
+
+    bool FrameLatchThread::acquire(LatchedTexture *frame) {
+        std::lock_guard<std::mutex> lockGuard(slotMutex);
+        Slot *ready = nullptr;
+        Slot *reading = nullptr;
+        for (Slot &slot : slots) {
+            if (slot.state == SlotState::Ready) ready = &slot;
+            if (slot.state == SlotState::Reading) reading = &slot;
+        }
+        if (ready == nullptr ||
+            eglClientWaitSync(egl.getDisplay(), ready->writeFence, 0, 0) !=
+            EGL_CONDITION_SATISFIED_KHR) {
+            return false;
+        }
+        destroySync(&ready->writeFence);
+        if (reading != nullptr) {
+            // Covers every draw that sampled it so far, they were all submitted already.
+            reading->readFence = eglCreateSync(egl.getDisplay(), EGL_SYNC_FENCE_KHR, nullptr);
+            glFlush();
+            reading->state = SlotState::Free;
+        }
+        ready->state = SlotState::Reading;
+        frame->textures[0] = ready->textures[0];
+        frame->textures[1] = ready->textures[1];
+        frame->poseMatrix = ready->poseMatrix;
+        return true;
+    }
+
+    void FrameLatchThread::destroySync(EGLSyncKHR *sync) {
+        if (*sync == EGL_NO_SYNC_KHR) return;
+        eglDestroySync(egl.getDisplay(), *sync);
+        *sync = EGL_NO_SYNC_KHR;
+    }
+}
@@ -0,0 +1,91 @@
+//
+// Latches and copies CloudXR frames on a thread of its own, so video arrival jitter stays off
+// the display loop. Frames go into a small ring of per eye textures on an EGL context shared
+// with the render thread, fenced so the render thread only picks up finished copies.
+//
+
+#ifndef CLOUDXRDEMO_FRAMELATCHTHREAD_H
+#define CLOUDXRDEMO_FRAMELATCHTHREAD_H
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <GLES3/gl32.h>
+#include "EGLHelper.h"
+#include "CloudXR.h"
+
+namespace ssnwt {
+    struct LatchedTexture {
+        GLuint textures[2];         // per eye
+        cxrMatrix34 poseMatrix;     // the server rendered the frame at
+    };
+
+    class FrameLatchThread {
+    public:
+        ~FrameLatchThread() { stop(); }
+
+        // Spawns the thread on a context shared with shared, which must be current on the
+        // calling thread. Every eye texture is width x height GL_RGBA8, like GraphicRender's.
+        bool start(CloudXR *cloudXr, const EGLHelper &shared, int32_t width, int32_t height);
+
+        // Joins the thread, cloudXr must stay connected until this returns.
+        void stop();
+
+        bool isRunning() const { return thread.joinable(); }
+
+        // Render thread: moves on to the newest frame whose copy has finished, never waiting
+        // for one. Returns true when that is a new frame, its textures stay valid until the
+        // next call.
+        bool acquire(LatchedTexture *frame);
+
+    private:
+        enum class SlotState {
+            Free,
+            Writing,
+            Ready,      // newest copy, not picked up yet
+            Reading,    // drawn by the render thread
+        };
+
+        struct Slot {
+            GLuint textures[2];
+            cxrMatrix34 poseMatrix;
+            SlotState state;
+            EGLSyncKHR writeFence;  // the copy into textures is done
+            EGLSyncKHR readFence;   // the render thread is done sampling textures
+        };
+
+        void run();
+
+        bool createSlots();
+
+        void destroySlots();
+
+        // Takes a free slot and waits until the render thread's reads of it are done.
+        Slot *beginWrite();
+
+        void publish(Slot *slot);
+
+        void destroySync(EGLSyncKHR *sync);
+
+        int64_t getSlotBytes() const;
+
+        CloudXR *cloudXr = nullptr;
+        EGLHelper egl;
+        int32_t width = 0;
+        int32_t height = 0;
+        GLuint framebuffer = 0;
+        std::thread thread;
+        std::atomic<bool> running{false};
+
+        // Three slots always leave one free: at most one is read and one is ready.
+        std::array<Slot, 3> slots{};
+        std::mutex slotMutex;
+
+        PFNEGLCREATESYNCKHRPROC eglCreateSync = nullptr;
+        PFNEGLDESTROYSYNCKHRPROC eglDestroySync = nullptr;
+        PFNEGLCLIENTWAITSYNCKHRPROC eglClientWaitSync = nullptr;
+    };
+}
+
+#endif //CLOUDXRDEMO_FRAMELATCHTHREAD_H
@@ -0,0 +1,60 @@
+#include <algorithm>
+#include "PosePollPolicy.h"
+
+namespace ssnwt {
+    // The SDK rejects poll rates above this.
+    constexpr uint32_t MAX_POSE_POLL_FREQ = 1000;
+    // Head turns faster than this (rad/s) are pushed every frame instead of waiting for a poll.
+    constexpr float PUSH_ANGULAR_SPEED = 1.5f;
+    // Below these speeds a device counts as resting, tracking noise stays well under them.
+    constexpr float IDLE_ANGULAR_SPEED = 0.05f;
+    constexpr float IDLE_LINEAR_SPEED = 0.01f;
+    // Same timeouts the SDK documents for cxrDeviceActivityLevel.
+    constexpr int64_t INTERACTION_TIMEOUT_NS = 500000000;
+    constexpr int64_t IDLE_TIMEOUT_NS = 10000000000;
+
+    static float lengthSquared(const cxrVector3 &v) {
+        return v.v[0] * v.v[0] + v.v[1] * v.v[1] + v.v[2] * v.v[2];
+    }
+
+    uint32_t PosePollPolicy::getPollFrequency(uint32_t fps) {
+        return std::min(2 * fps, MAX_POSE_POLL_FREQ);
+    }
+
+    void PosePollPolicy::reset() {
+        lastActivityNs = 0;
+    }
+
+    bool PosePollPolicy::isMoving(const cxrVRTrackingState &trackingState) const {
+        const cxrTrackedDevicePose *poses[] = {&trackingState.hmd.pose,
+                                               &trackingState.controller[0].pose,
+                                               &trackingState.controller[1].pose};
+        for (const cxrTrackedDevicePose *pose : poses) {
+            if (!pose->poseIsValid) continue;
+            if (lengthSquared(pose->angularVelocity) > IDLE_ANGULAR_SPEED * IDLE_ANGULAR_SPEED ||
+                lengthSquared(pose->velocity) > IDLE_LINEAR_SPEED * IDLE_LINEAR_SPEED) {
+                return true;
+            }
+        }
+        for (const cxrControllerTrackingState &controller : trackingState.controller) {
+            if (controller.booleanComps != 0) return true;
+        }
+        return false;
+    }
+
+    bool PosePollPolicy::update(int64_t timeNs, cxrVRTrackingState *trackingState) {
+        if (isMoving(*trackingState) || lastActivityNs == 0) lastActivityNs = timeNs;
+        const int64_t restingNs = timeNs - lastActivityNs;
+        if (restingNs >= IDLE_TIMEOUT_NS) {
+            trackingState->hmd.activityLevel = cxrDeviceActivityLevel_Idle;
+        } else if (restingNs >= INTERACTION_TIMEOUT_NS) {
+            trackingState->hmd.activityLevel = cxrDeviceActivityLevel_UserInteraction_Timeout;
+        } else {
+            trackingState->hmd.activityLevel = cxrDeviceActivityLevel_UserInteraction;
+        }
+
+        const cxrTrackedDevicePose &hmd = trackingState->hmd.pose;
+        return hmd.poseIsValid &&
+               lengthSquared(hmd.angularVelocity) > PUSH_ANGULAR_SPEED * PUSH_ANGULAR_SPEED;
+    }
+}
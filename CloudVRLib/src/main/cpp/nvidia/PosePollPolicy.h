@@ -0,0 +1,32 @@
+//
+// How often poses go to the server: the SDK poll rate picked at connect time, extra pushes
+// through cxrSendPose while the head turns fast, and the activity level reported when idle.
+//
+
+#ifndef CLOUDXRDEMO_POSEPOLLPOLICY_H
+#define CLOUDXRDEMO_POSEPOLLPOLICY_H
+
+#include <cstdint>
+#include "CloudXRCommon.h"
+
+namespace ssnwt {
+    class PosePollPolicy {
+    public:
+        // cxrDeviceDesc::posePollFreq for a display refresh rate, twice the refresh as the
+        // SDK recommends, 0 (SDK default) when the rate is unknown.
+        static uint32_t getPollFrequency(uint32_t fps);
+
+        void reset();
+
+        // Classifies a freshly sampled state, fills hmd.activityLevel and returns true when
+        // it is worth pushing to the server ahead of the next poll.
+        bool update(int64_t timeNs, cxrVRTrackingState *trackingState);
+
+    private:
+        bool isMoving(const cxrVRTrackingState &trackingState) const;
+
+        int64_t lastActivityNs = 0;
+    };
+}
+
+#endif //CLOUDXRDEMO_POSEPOLLPOLICY_H
@@ -54,6 +54,20 @@ public:
     int32_t mFoveation;
     cxrGraphicsContextType mGfxType;
     std::string mUserData;
+    bool mPredictDisplayTime;
+    uint32_t mButtonDebounce;
+    uint32_t mPosePredictor;
+    std::string mPoseRecordPath;
+    std::string mPoseReplayPath;
+    uint32_t mPosePollFreq;
+    bool mPushPoses;
+    uint32_t mReprojection;
+    bool mMultiview;
+    int32_t mLatchTimeoutMs;
+    bool mLatchThread;
+    float mMaxClientQueueSize;
+    bool mDisableVVSync;
+    uint32_t mSuspendTimeoutS;
 
     ClientOptions() :
             mServerIP{""},
@@ -70,6 +84,18 @@ public:
             mReceiverMode(cxrStreamingMode_XR),
             mDebugFlags(0),
             mFoveation(0),
+            mPredictDisplayTime(true),
+            mButtonDebounce(0),
+            mPosePredictor(0),
+            mPosePollFreq(0),
+            mPushPoses(true),
+            mReprojection(1),
+            mMultiview(true),
+            mLatchTimeoutMs(-1),
+            mLatchThread(false),
+            mMaxClientQueueSize(0),
+            mDisableVVSync(false),
+            mSuspendTimeoutS(60),
 #ifdef _WIN32
             mGfxType(cxrGraphicsContext_D3D11)
 #elif defined(__linux__)
@@ -197,6 +223,139 @@ public:
 
                 return ParseStatus_Success;
             });
+        AddOption("pose-lookahead", "pl", false, "Locate poses a fixed 2 ms ahead instead of at the predicted display time",
+            HANDLER_LAMBDA_FN { mPredictDisplayTime = false; return ParseStatus_Success; });
+        AddOption("button-debounce", "bd", true, "Frames a controller button must hold a new state before it is sent [0-10], 0 disables",
+            HANDLER_LAMBDA_FN
+            {
+                uint32_t frames;
+                std::stringstream ss(tok); ss >> frames;
+                if (frames <= 10)
+                {
+                    mButtonDebounce = frames;
+                    return ParseStatus_Success;
+                }
+                return ParseStatus_BadVal;
+            });
+        AddOption("pose-predictor", "pp", true, "Predict poses on the client instead of the server. [none|cv|ca|kalman]",
+            HANDLER_LAMBDA_FN
+            {
+                // Values match ssnwt::PredictionModel.
+                if (tok == "none")
+                {
+                    mPosePredictor = 0;
+                }
+                else if (tok == "cv")
+                {
+                    mPosePredictor = 1;
+                }
+                else if (tok == "ca")
+                {
+                    mPosePredictor = 2;
+                }
+                else if (tok == "kalman")
+                {
+                    mPosePredictor = 3;
+                }
+                else
+                {
+                    return ParseStatus_BadVal;
+                }
+                return ParseStatus_Success;
+            });
+        AddOption("pose-record", "prc", true, "Record every tracking state sent to the server to the given file",
+            HANDLER_LAMBDA_FN { mPoseRecordPath = tok; return ParseStatus_Success; });
+        AddOption("pose-replay", "prp", true, "Send the tracking states recorded in the given file instead of live tracking",
+            HANDLER_LAMBDA_FN { mPoseReplayPath = tok; return ParseStatus_Success; });
+        AddOption("pose-poll-freq", "ppf", true, "Pose poll rate in Hz [0-1000], 0 polls at twice the display rate",
+            HANDLER_LAMBDA_FN
+            {
+                uint32_t freq;
+                std::stringstream ss(tok); ss >> freq;
+                if (freq <= 1000)
+                {
+                    mPosePollFreq = freq;
+                    return ParseStatus_Success;
+                }
+                return ParseStatus_BadVal;
+            });
+        AddOption("latch-timeout", "lt", true, "Milliseconds to wait for a new frame before repeating the last one [0-100], -1 waits a quarter of the display period",
+            HANDLER_LAMBDA_FN
+            {
+                int32_t timeoutMs = -2;
+                std::stringstream ss(tok); ss >> timeoutMs;
+                if (timeoutMs >= -1 && timeoutMs <= 100)
+                {
+                    mLatchTimeoutMs = timeoutMs;
+                    return ParseStatus_Success;
+                }
+                return ParseStatus_BadVal;
+            });
+        AddOption("latch-thread", "lth", false, "Latch and copy frames on a thread of their own instead of blitting on the render thread",
+            HANDLER_LAMBDA_FN { mLatchThread = true; return ParseStatus_Success; });
+        AddOption("latency-preset", "lp", true, "Trade latency for smoothness with the decoded frame queue depth and VVSync. [lowest-latency|balanced|smooth]",
+            HANDLER_LAMBDA_FN
+            {
+                if (tok == "lowest-latency")
+                {
+                    mMaxClientQueueSize = 1;
+                    mDisableVVSync = false;
+                }
+                else if (tok == "balanced")
+                {
+                    mMaxClientQueueSize = 2;
+                    mDisableVVSync = false;
+                }
+                else if (tok == "smooth")
+                {
+                    // Rides out Wi-Fi retransmits, the server keeps its own pace.
+                    mMaxClientQueueSize = 4;
+                    mDisableVVSync = true;
+                }
+                else
+                {
+                    return ParseStatus_BadVal;
+                }
+                return ParseStatus_Success;
+            });
+        AddOption("suspend-timeout", "sut", true, "Seconds to keep the connection while paused so resuming skips the handshake [0-3600], 0 disconnects at once",
+            HANDLER_LAMBDA_FN
+            {
+                int32_t timeoutS = -1;
+                std::stringstream ss(tok); ss >> timeoutS;
+                if (timeoutS >= 0 && timeoutS <= 3600)
+                {
+                    mSuspendTimeoutS = (uint32_t) timeoutS;
+                    return ParseStatus_Success;
+                }
+                return ParseStatus_BadVal;
+            });
+        AddOption("no-pose-push", "npp", false, "Only send poses when polled, not also on fast head motion",
+            HANDLER_LAMBDA_FN { mPushPoses = false; return ParseStatus_Success; });
+        AddOption("reprojection", "rp", true, "Correct latched frames for head rotation by the runtime, by a client shader pass or not at all. [compositor|shader|none]",
+            HANDLER_LAMBDA_FN
+            {
+                // Values match ssnwt::Reprojection.
+                if (tok == "none")
+                {
+                    mReprojection = 0;
+                }
+                else if (tok == "compositor")
+                {
+                    mReprojection = 1;
+                }
+                else if (tok == "shader")
+                {
+                    mReprojection = 2;
+                }
+                else
+                {
+                    return ParseStatus_BadVal;
+                }
+                return ParseStatus_Success;
+            });
+        AddOption("no-multiview", "nmv", false, "Draw the eyes of the shader path one at a time instead of in one multiview pass",
+            HANDLER_LAMBDA_FN { mMultiview = false; return ParseStatus_Success; });
         AddOption("user-data", "u", true, "Send a user string to the server",
             HANDLER_LAMBDA_FN { mUserData = tok; return ParseStatus_Success; });
         AddOption("foveation", "f", true, "Enable foveated scaling at given percentage scale [0-100]",
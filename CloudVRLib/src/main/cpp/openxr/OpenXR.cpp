@@ -1,9 +1,74 @@
 #include <EGL/egl.h>
 #include <GLES3/gl32.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
 #include <vector>
 #include "common.h"
+#include "GpuMemory.h"
+#include "PoseMath.h"
 
 namespace ssnwt {
+    // Lookahead used by PoseTimeMode::Lookahead.
+    constexpr XrDuration TRACKING_LOOKAHEAD_NS = 2000000;
+    // Below this head speed (rad/s) latched poses are too alike to tell apart.
+    constexpr float MIN_MATCH_ANGULAR_SPEED = 0.3f;
+    // How many of the newest history samples a latched pose is matched against.
+    constexpr uint32_t MATCH_SAMPLE_COUNT = 32;
+    constexpr float POSE_TIME_OFFSET_GAIN = 0.1f;
+    constexpr float MAX_POSE_TIME_OFFSET = 0.1f;
+    // How often the latch to display age and the fresh/repeated frame counts are logged.
+    constexpr XrDuration FRAME_STATS_LOG_PERIOD_NS = 1000000000;
+
+    struct ActionInfo {
+        const char *name;
+        const char *localizedName;
+        XrActionType type;
+        // cxrButtonId for buttons, cxrAnalogId for values (the X axis of a 2D value), -1 if
+        // the action is not forwarded to the server.
+        int32_t component;
+        // Suggested bindings on the Skyworth touch controller, per hand.
+        const char *bindings[Side::COUNT];
+    };
+
+    // Indexed by Action, adding a controller input only needs a row here.
+    static const ActionInfo ACTIONS[Action::COUNT] = {
+            {"primarybutton",     "Primary Button",     XR_ACTION_TYPE_BOOLEAN_INPUT,    cxrButton_A,
+                    {"/user/hand/left/input/x/click",    "/user/hand/right/input/a/click"}},
+            {"secondarybutton",   "Secondary Button",   XR_ACTION_TYPE_BOOLEAN_INPUT,    cxrButton_B,
+                    {"/user/hand/left/input/y/click",    "/user/hand/right/input/b/click"}},
+            {"grippressed",       "Grip Pressed",       XR_ACTION_TYPE_BOOLEAN_INPUT,    cxrButton_Grip_Click,
+                    {}},
+            {"menu",              "Menu",               XR_ACTION_TYPE_BOOLEAN_INPUT,    cxrButton_System,
+                    {"/user/hand/left/input/menu/click", "/user/hand/right/input/menu/click"}},
+            {"triggerpressed",    "Trigger Pressed",    XR_ACTION_TYPE_BOOLEAN_INPUT,    cxrButton_Trigger_Click,
+                    {}},
+            {"triggertouched",    "Trigger Touched",    XR_ACTION_TYPE_BOOLEAN_INPUT,    cxrButton_Trigger_Touch,
+                    {}},
+            {"thumbstickclicked", "Thumbstick Clicked", XR_ACTION_TYPE_BOOLEAN_INPUT,    cxrButton_Joystick_Click,
+                    {}},
+            {"thumbsticktouched", "Thumbstick Touched", XR_ACTION_TYPE_BOOLEAN_INPUT,    cxrButton_Joystick_Touch,
+                    {}},
+            {"grip",              "Grip",               XR_ACTION_TYPE_FLOAT_INPUT,      cxrAnalog_Grip,
+                    {}},
+            {"trigger",           "Trigger",            XR_ACTION_TYPE_FLOAT_INPUT,      cxrAnalog_Trigger,
+                    {}},
+            {"thumbstick",        "Thumbstick",         XR_ACTION_TYPE_VECTOR2F_INPUT,   cxrAnalog_TouchpadX,
+                    {}},
+            {"devicepose",        "Device Pose",        XR_ACTION_TYPE_POSE_INPUT,       -1,
+                    {"/user/hand/left/input/grip/pose",  "/user/hand/right/input/grip/pose"}},
+            {"haptic",            "Haptic Output",      XR_ACTION_TYPE_VIBRATION_OUTPUT, -1,
+                    {}},
+            {"enterButton",       "Enter Button",       XR_ACTION_TYPE_BOOLEAN_INPUT,    -1,
+                    {}},
+            {"homeButton",        "Home Button",        XR_ACTION_TYPE_BOOLEAN_INPUT,    -1,
+                    {}},
+            {"volumeDownButton",  "VolumeDown Button",  XR_ACTION_TYPE_BOOLEAN_INPUT,    -1,
+                    {}},
+            {"volumeUpButton",    "VolumeUp Button",    XR_ACTION_TYPE_BOOLEAN_INPUT,    -1,
+                    {}},
+    };
+
     OpenXR::OpenXR(JavaVM *vm, jobject activity) {
         ALOGD("[OpenXR]+");
         PFN_xrInitializeLoaderKHR initializeLoader = nullptr;
@@ -20,6 +85,21 @@ namespace ssnwt {
 
         std::vector<const char *> extensions = {XR_KHR_OPENGL_ES_ENABLE_EXTENSION_NAME,
                                                 XR_KHR_ANDROID_CREATE_INSTANCE_EXTENSION_NAME};
+        uint32_t extensionCount = 0;
+        OPENXR_CHECK(xrEnumerateInstanceExtensionProperties(nullptr, 0, &extensionCount, nullptr));
+        std::vector<XrExtensionProperties> extensionProperties(extensionCount,
+                                                               {XR_TYPE_EXTENSION_PROPERTIES});
+        OPENXR_CHECK(xrEnumerateInstanceExtensionProperties(nullptr, extensionCount,
+                                                            &extensionCount,
+                                                            extensionProperties.data()));
+        bool hasConvertTimespecTime = false;
+        for (const XrExtensionProperties &extension : extensionProperties) {
+            if (strcmp(extension.extensionName,
+                       XR_KHR_CONVERT_TIMESPEC_TIME_EXTENSION_NAME) == 0) {
+                extensions.push_back(XR_KHR_CONVERT_TIMESPEC_TIME_EXTENSION_NAME);
+                hasConvertTimespecTime = true;
+            }
+        }
 
         XrInstanceCreateInfoAndroidKHR instanceCreateInfoAndroid{
                 XR_TYPE_INSTANCE_CREATE_INFO_ANDROID_KHR};
@@ -35,6 +115,13 @@ namespace ssnwt {
         createInfo.applicationInfo.apiVersion = XR_CURRENT_API_VERSION;
         OPENXR_CHECK(xrCreateInstance(&createInfo, &m_instance));
         ALOGD("[OpenXR]xrCreateInstance %p", &m_instance);
+        if (hasConvertTimespecTime) {
+            OPENXR_CHECK(xrGetInstanceProcAddr(m_instance, "xrConvertTimespecTimeToTimeKHR",
+                                               reinterpret_cast<PFN_xrVoidFunction *>(&m_pfnConvertTimespecTimeToTime)));
+        } else {
+            ALOGW("[OpenXR]%s unsupported, assuming XrTime is CLOCK_MONOTONIC",
+                  XR_KHR_CONVERT_TIMESPEC_TIME_EXTENSION_NAME);
+        }
 
         XrSystemGetInfo systemInfo{XR_TYPE_SYSTEM_GET_INFO};
         systemInfo.formFactor = XR_FORM_FACTOR_HEAD_MOUNTED_DISPLAY;
@@ -109,236 +196,32 @@ namespace ssnwt {
                 OPENXR_CHECK(xrStringToPath(m_instance, "/user/head", &m_input.headSubactionPath));
             }
 
-            // Create Controller actions.
+            // Create the actions and suggest bindings for the Skyworth touch controller.
             {
-                // Create an input action for grabbing objects with the left and right hands.
                 XrActionCreateInfo actionInfo{XR_TYPE_ACTION_CREATE_INFO};
-                actionInfo.actionType = XR_ACTION_TYPE_BOOLEAN_INPUT;
-                strcpy_s(actionInfo.actionName, "primarybutton");
-                strcpy_s(actionInfo.localizedActionName, "Primary Button");
-                actionInfo.countSubactionPaths = uint32_t(m_input.handSubactionPath.size());
-                actionInfo.subactionPaths = m_input.handSubactionPath.data();
-                OPENXR_CHECK(xrCreateAction(m_input.actionSet, &actionInfo,
-                                            &m_input.primaryButtonAction));
-
-                actionInfo.actionType = XR_ACTION_TYPE_BOOLEAN_INPUT;
-                strcpy_s(actionInfo.actionName, "secondarybutton");
-                strcpy_s(actionInfo.localizedActionName, "Secondary Button");
-                actionInfo.countSubactionPaths = uint32_t(m_input.handSubactionPath.size());
-                actionInfo.subactionPaths = m_input.handSubactionPath.data();
-                OPENXR_CHECK(xrCreateAction(m_input.actionSet, &actionInfo,
-                                            &m_input.secondaryButtonAction));
-
-
-                actionInfo.actionType = XR_ACTION_TYPE_BOOLEAN_INPUT;
-                strcpy_s(actionInfo.actionName, "grippressed");
-                strcpy_s(actionInfo.localizedActionName, "Grip Pressed");
-                actionInfo.countSubactionPaths = uint32_t(m_input.handSubactionPath.size());
-                actionInfo.subactionPaths = m_input.handSubactionPath.data();
-                OPENXR_CHECK(
-                        xrCreateAction(m_input.actionSet, &actionInfo, &m_input.gripPressedAction));
-
-                actionInfo.actionType = XR_ACTION_TYPE_BOOLEAN_INPUT;
-                strcpy_s(actionInfo.actionName, "menu");
-                strcpy_s(actionInfo.localizedActionName, "Menu");
-                actionInfo.countSubactionPaths = uint32_t(m_input.handSubactionPath.size());
-                actionInfo.subactionPaths = m_input.handSubactionPath.data();
-                OPENXR_CHECK(xrCreateAction(m_input.actionSet, &actionInfo, &m_input.menuAction));
-
-                actionInfo.actionType = XR_ACTION_TYPE_BOOLEAN_INPUT;
-                strcpy_s(actionInfo.actionName, "triggerpressed");
-                strcpy_s(actionInfo.localizedActionName, "Trigger Pressed");
-                actionInfo.countSubactionPaths = uint32_t(m_input.handSubactionPath.size());
-                actionInfo.subactionPaths = m_input.handSubactionPath.data();
-                OPENXR_CHECK(xrCreateAction(m_input.actionSet, &actionInfo,
-                                            &m_input.triggerPressedAction));
-
-                actionInfo.actionType = XR_ACTION_TYPE_BOOLEAN_INPUT;
-                strcpy_s(actionInfo.actionName, "triggertouched");
-                strcpy_s(actionInfo.localizedActionName, "Trigger Touched");
                 actionInfo.countSubactionPaths = uint32_t(m_input.handSubactionPath.size());
                 actionInfo.subactionPaths = m_input.handSubactionPath.data();
-                OPENXR_CHECK(xrCreateAction(m_input.actionSet, &actionInfo,
-                                            &m_input.triggerTouchedAction));
-
-                actionInfo.actionType = XR_ACTION_TYPE_BOOLEAN_INPUT;
-                strcpy_s(actionInfo.actionName, "thumbstickclicked");
-                strcpy_s(actionInfo.localizedActionName, "Thumbstick Clicked");
-                actionInfo.countSubactionPaths = uint32_t(m_input.handSubactionPath.size());
-                actionInfo.subactionPaths = m_input.handSubactionPath.data();
-                OPENXR_CHECK(xrCreateAction(m_input.actionSet, &actionInfo,
-                                            &m_input.thumbstickClickedAction));
-
-                actionInfo.actionType = XR_ACTION_TYPE_BOOLEAN_INPUT;
-                strcpy_s(actionInfo.actionName, "thumbsticktouched");
-                strcpy_s(actionInfo.localizedActionName, "Thumbstick Touched");
-                actionInfo.countSubactionPaths = uint32_t(m_input.handSubactionPath.size());
-                actionInfo.subactionPaths = m_input.handSubactionPath.data();
-                OPENXR_CHECK(xrCreateAction(m_input.actionSet, &actionInfo,
-                                            &m_input.thumbstickTouchedAction));
-
-                actionInfo.actionType = XR_ACTION_TYPE_FLOAT_INPUT;
-                strcpy_s(actionInfo.actionName, "grip");
-                strcpy_s(actionInfo.localizedActionName, "Grip");
-                actionInfo.countSubactionPaths = uint32_t(m_input.handSubactionPath.size());
-                actionInfo.subactionPaths = m_input.handSubactionPath.data();
-                OPENXR_CHECK(xrCreateAction(m_input.actionSet, &actionInfo, &m_input.gripAction));
-
-                actionInfo.actionType = XR_ACTION_TYPE_FLOAT_INPUT;
-                strcpy_s(actionInfo.actionName, "trigger");
-                strcpy_s(actionInfo.localizedActionName, "Trigger");
-                actionInfo.countSubactionPaths = uint32_t(m_input.handSubactionPath.size());
-                actionInfo.subactionPaths = m_input.handSubactionPath.data();
-                OPENXR_CHECK(
-                        xrCreateAction(m_input.actionSet, &actionInfo, &m_input.triggerAction));
-
-                actionInfo.actionType = XR_ACTION_TYPE_VECTOR2F_INPUT;
-                strcpy_s(actionInfo.actionName, "thumbstick");
-                strcpy_s(actionInfo.localizedActionName, "Thumbstick");
-                actionInfo.countSubactionPaths = uint32_t(m_input.handSubactionPath.size());
-                actionInfo.subactionPaths = m_input.handSubactionPath.data();
-                OPENXR_CHECK(
-                        xrCreateAction(m_input.actionSet, &actionInfo, &m_input.thumbstickAction));
-
-                actionInfo.actionType = XR_ACTION_TYPE_POSE_INPUT;
-                strcpy_s(actionInfo.actionName, "devicepose");
-                strcpy_s(actionInfo.localizedActionName, "Device Pose");
-                actionInfo.countSubactionPaths = uint32_t(m_input.handSubactionPath.size());
-                actionInfo.subactionPaths = m_input.handSubactionPath.data();
-                OPENXR_CHECK(xrCreateAction(m_input.actionSet, &actionInfo, &m_input.poseAction));
-
-                // Create output actions for vibrating the left and right controller.
-                actionInfo.actionType = XR_ACTION_TYPE_VIBRATION_OUTPUT;
-                strcpy_s(actionInfo.actionName, "haptic");
-                strcpy_s(actionInfo.localizedActionName, "Haptic Output");
-                actionInfo.countSubactionPaths = uint32_t(m_input.handSubactionPath.size());
-                actionInfo.subactionPaths = m_input.handSubactionPath.data();
-                OPENXR_CHECK(xrCreateAction(m_input.actionSet, &actionInfo, &m_input.hapticAction));
-
-            }
-
-            //Creat HMD Action
-            {
-                XrActionCreateInfo actionInfo{XR_TYPE_ACTION_CREATE_INFO};
-                actionInfo.actionType = XR_ACTION_TYPE_BOOLEAN_INPUT;
-                strcpy_s(actionInfo.actionName, "enterButton");
-                strcpy_s(actionInfo.localizedActionName, "Enter Button");
-                actionInfo.countSubactionPaths = uint32_t(m_input.handSubactionPath.size());
-                actionInfo.subactionPaths = m_input.handSubactionPath.data();
-                OPENXR_CHECK(
-                        xrCreateAction(m_input.actionSet, &actionInfo, &m_input.EnterButtonAction));
-
-                actionInfo.actionType = XR_ACTION_TYPE_BOOLEAN_INPUT;
-                strcpy_s(actionInfo.actionName, "homeButton");
-                strcpy_s(actionInfo.localizedActionName, "Home Button");
-                actionInfo.countSubactionPaths = uint32_t(m_input.handSubactionPath.size());
-                actionInfo.subactionPaths = m_input.handSubactionPath.data();
-                OPENXR_CHECK(
-                        xrCreateAction(m_input.actionSet, &actionInfo, &m_input.HomeButtonAction));
-
-                actionInfo.actionType = XR_ACTION_TYPE_BOOLEAN_INPUT;
-                strcpy_s(actionInfo.actionName, "volumeDownButton");
-                strcpy_s(actionInfo.localizedActionName, "VolumeDown Button");
-                actionInfo.countSubactionPaths = uint32_t(m_input.handSubactionPath.size());
-                actionInfo.subactionPaths = m_input.handSubactionPath.data();
-                OPENXR_CHECK(
-                        xrCreateAction(m_input.actionSet, &actionInfo, &m_input.VolumeDownAction));
-
-                actionInfo.actionType = XR_ACTION_TYPE_BOOLEAN_INPUT;
-                strcpy_s(actionInfo.actionName, "volumeUpButton");
-                strcpy_s(actionInfo.localizedActionName, "VolumeUp Button");
-                actionInfo.countSubactionPaths = uint32_t(m_input.handSubactionPath.size());
-                actionInfo.subactionPaths = m_input.handSubactionPath.data();
-                OPENXR_CHECK(
-                        xrCreateAction(m_input.actionSet, &actionInfo, &m_input.VolumeUpAction));
-            }
-
-            // Suggest bindings for the Oculus Touch.
-            {
-                std::array<XrPath, Side::COUNT> primaryButtonPath{};
-                std::array<XrPath, Side::COUNT> primaryTouchPath{};
-                std::array<XrPath, Side::COUNT> secondaryButtonPath{};
-                std::array<XrPath, Side::COUNT> secondaryTouchedPath{};
-                std::array<XrPath, Side::COUNT> menuClickPath{};
-                std::array<XrPath, Side::COUNT> selectPath{};
-                std::array<XrPath, Side::COUNT> squeezeValuePath{};
-                std::array<XrPath, Side::COUNT> squeezeForcePath{};
-                std::array<XrPath, Side::COUNT> squeezeClickPath{};
-                std::array<XrPath, Side::COUNT> posePath{};
-                std::array<XrPath, Side::COUNT> hapticPath{};
-                std::array<XrPath, Side::COUNT> triggerValuePath{};
-                std::array<XrPath, Side::COUNT> gripValuePath{};
-                OPENXR_CHECK(xrStringToPath(m_instance, "/user/hand/left/input/x/click",
-                                            &primaryButtonPath[Side::LEFT]));
-                OPENXR_CHECK(xrStringToPath(m_instance, "/user/hand/right/input/a/click",
-                                            &primaryButtonPath[Side::RIGHT]));
-                OPENXR_CHECK(xrStringToPath(m_instance, "/user/hand/left/input/y/click",
-                                            &secondaryButtonPath[Side::LEFT]));
-                OPENXR_CHECK(xrStringToPath(m_instance, "/user/hand/right/input/b/click",
-                                            &secondaryButtonPath[Side::RIGHT]));
-                OPENXR_CHECK(xrStringToPath(m_instance, "/user/hand/left/input/x/touch",
-                                            &primaryTouchPath[Side::LEFT]));
-                OPENXR_CHECK(xrStringToPath(m_instance, "/user/hand/right/input/a/touch",
-                                            &primaryTouchPath[Side::RIGHT]));
-                OPENXR_CHECK(xrStringToPath(m_instance, "/user/hand/left/input/y/touch",
-                                            &secondaryTouchedPath[Side::LEFT]));
-                OPENXR_CHECK(xrStringToPath(m_instance, "/user/hand/right/input/b/touch",
-                                            &secondaryTouchedPath[Side::RIGHT]));
-                OPENXR_CHECK(xrStringToPath(m_instance, "/user/hand/left/input/menu/click",
-                                            &menuClickPath[Side::LEFT]));
-                OPENXR_CHECK(xrStringToPath(m_instance, "/user/hand/right/input/menu/click",
-                                            &menuClickPath[Side::RIGHT]));
-
-                OPENXR_CHECK(xrStringToPath(m_instance, "/user/hand/left/input/select/click",
-                                            &selectPath[Side::LEFT]));
-                OPENXR_CHECK(xrStringToPath(m_instance, "/user/hand/right/input/select/click",
-                                            &selectPath[Side::RIGHT]));
-                OPENXR_CHECK(xrStringToPath(m_instance, "/user/hand/left/input/squeeze/value",
-                                            &squeezeValuePath[Side::LEFT]));
-                OPENXR_CHECK(xrStringToPath(m_instance, "/user/hand/right/input/squeeze/value",
-                                            &squeezeValuePath[Side::RIGHT]));
-                OPENXR_CHECK(xrStringToPath(m_instance, "/user/hand/left/input/squeeze/force",
-                                            &squeezeForcePath[Side::LEFT]));
-                OPENXR_CHECK(xrStringToPath(m_instance, "/user/hand/right/input/squeeze/force",
-                                            &squeezeForcePath[Side::RIGHT]));
-                OPENXR_CHECK(xrStringToPath(m_instance, "/user/hand/left/input/squeeze/click",
-                                            &squeezeClickPath[Side::LEFT]));
-                OPENXR_CHECK(xrStringToPath(m_instance, "/user/hand/right/input/squeeze/click",
-                                            &squeezeClickPath[Side::RIGHT]));
-                OPENXR_CHECK(xrStringToPath(m_instance, "/user/hand/left/input/grip/pose",
-                                            &posePath[Side::LEFT]));
-                OPENXR_CHECK(xrStringToPath(m_instance, "/user/hand/right/input/grip/pose",
-                                            &posePath[Side::RIGHT]));
-                OPENXR_CHECK(xrStringToPath(m_instance, "/user/hand/left/output/haptic",
-                                            &hapticPath[Side::LEFT]));
-                OPENXR_CHECK(xrStringToPath(m_instance, "/user/hand/right/output/haptic",
-                                            &hapticPath[Side::RIGHT]));
-
-                OPENXR_CHECK(xrStringToPath(m_instance, "/user/hand/left/input/trigger/value",
-                                            &triggerValuePath[Side::LEFT]));
-                OPENXR_CHECK(xrStringToPath(m_instance, "/user/hand/right/input/trigger/value",
-                                            &triggerValuePath[Side::RIGHT]));
-                OPENXR_CHECK(xrStringToPath(m_instance, "/user/hand/left/input/grip/value",
-                                            &gripValuePath[Side::LEFT]));
-                OPENXR_CHECK(xrStringToPath(m_instance, "/user/hand/right/input/grip/value",
-                                            &gripValuePath[Side::RIGHT]));
+                std::vector<XrActionSuggestedBinding> bindings;
+                for (uint32_t i = 0; i < Action::COUNT; i++) {
+                    const ActionInfo &info = ACTIONS[i];
+                    actionInfo.actionType = info.type;
+                    strcpy_s(actionInfo.actionName, info.name);
+                    strcpy_s(actionInfo.localizedActionName, info.localizedName);
+                    OPENXR_CHECK(xrCreateAction(m_input.actionSet, &actionInfo,
+                                                &m_input.actions[i]));
+                    for (const char *bindingPath : info.bindings) {
+                        if (bindingPath == nullptr) continue;
+                        XrActionSuggestedBinding binding{m_input.actions[i], XR_NULL_PATH};
+                        OPENXR_CHECK(xrStringToPath(m_instance, bindingPath, &binding.binding));
+                        bindings.push_back(binding);
+                    }
+                }
 
                 XrPath skyworthTouchInteractionProfilePath;
                 OPENXR_CHECK(
                         xrStringToPath(m_instance,
                                        "/interaction_profiles/skyworth/touch_controller",
                                        &skyworthTouchInteractionProfilePath));
-                std::vector<XrActionSuggestedBinding> bindings{
-                        {
-                                {m_input.primaryButtonAction, primaryButtonPath[Side::LEFT]},
-                                {m_input.primaryButtonAction, primaryButtonPath[Side::RIGHT]},
-                                {m_input.secondaryButtonAction, secondaryButtonPath[Side::LEFT]},
-                                {m_input.secondaryButtonAction, secondaryButtonPath[Side::RIGHT]},
-                                {m_input.menuAction, menuClickPath[Side::LEFT]},
-                                {m_input.menuAction, menuClickPath[Side::RIGHT]},
-                                {m_input.poseAction, posePath[Side::LEFT]},
-                                {m_input.poseAction, posePath[Side::RIGHT]},
-                        }};
                 XrInteractionProfileSuggestedBinding suggestedBindings{
                         XR_TYPE_INTERACTION_PROFILE_SUGGESTED_BINDING};
                 suggestedBindings.interactionProfile = skyworthTouchInteractionProfilePath;
@@ -348,7 +231,7 @@ namespace ssnwt {
             }
 
             XrActionSpaceCreateInfo actionSpaceInfo{XR_TYPE_ACTION_SPACE_CREATE_INFO};
-            actionSpaceInfo.action = m_input.poseAction;
+            actionSpaceInfo.action = m_input.actions[Action::Pose];
             actionSpaceInfo.poseInActionSpace.orientation.w = 1.f;
             actionSpaceInfo.subactionPath = m_input.handSubactionPath[Side::LEFT];
             OPENXR_CHECK(xrCreateActionSpace(m_session, &actionSpaceInfo,
@@ -370,6 +253,11 @@ namespace ssnwt {
             spaceCreateInfo.poseInReferenceSpace.orientation.w = 1.0f;
             OPENXR_CHECK(xrCreateReferenceSpace(m_session, &spaceCreateInfo, &m_appSpace));
             ALOGV("[OpenXR]xrCreateReferenceSpace:%p", &m_appSpace);
+            spaceCreateInfo.referenceSpaceType = getTrackingSpaceType();
+            OPENXR_CHECK(xrCreateReferenceSpace(m_session, &spaceCreateInfo, &m_trackingSpace));
+            ALOGD("[OpenXR]tracking in %s space",
+                  spaceCreateInfo.referenceSpaceType == XR_REFERENCE_SPACE_TYPE_STAGE ? "STAGE"
+                                                                                      : "LOCAL");
         }
 
         uint32_t viewCount;
@@ -384,6 +272,8 @@ namespace ssnwt {
                                                        m_configViews.data()));
 
         m_views.resize(viewCount, {XR_TYPE_VIEW});
+        // Sized once, the frame loop only overwrites them.
+        m_projectionLayerViews.resize(viewCount);
 
         // create swapchain
         if (viewCount > 0) {
@@ -396,6 +286,8 @@ namespace ssnwt {
                                                      swapchainFormats.data()));
             CHECK(swapchainFormatCount == swapchainFormats.size());
 
+            // No sRGB: the stream is already gamma encoded, an sRGB swapchain would encode it
+            // again on every write.
             std::vector<int64_t> supportedColorSwapchainFormats{GL_RGBA8, GL_RGBA8_SNORM};
             auto swapchainFormatIt = std::find_first_of(swapchainFormats.begin(),
                                                         swapchainFormats.end(),
@@ -406,50 +298,127 @@ namespace ssnwt {
             }
             m_colorSwapchainFormat = *swapchainFormatIt;
 
-            for (int i = 0; i < viewCount; i++) {
-                const XrViewConfigurationView &vp = m_configViews[i];
-                ALOGV("[OpenXR]Creating swapchain for view %d with dimensions Width=%d Height=%d SampleCount=%d",
-                      i,
-                      vp.recommendedImageRectWidth, vp.recommendedImageRectHeight,
-                      vp.recommendedSwapchainSampleCount);
-                // Create the swapchain.
-                XrSwapchainCreateInfo swapchainCreateInfo{XR_TYPE_SWAPCHAIN_CREATE_INFO};
-                swapchainCreateInfo.arraySize = 1;
-                swapchainCreateInfo.format = m_colorSwapchainFormat;
-                swapchainCreateInfo.width = vp.recommendedImageRectWidth;
-                swapchainCreateInfo.height = vp.recommendedImageRectHeight;
-                swapchainCreateInfo.mipCount = 1;
-                swapchainCreateInfo.faceCount = 1;
-                swapchainCreateInfo.sampleCount = vp.recommendedSwapchainSampleCount;
-                swapchainCreateInfo.usageFlags =
-                        XR_SWAPCHAIN_USAGE_SAMPLED_BIT | XR_SWAPCHAIN_USAGE_COLOR_ATTACHMENT_BIT;
-                Swapchain swapchain{};
-                swapchain.width = (int32_t) swapchainCreateInfo.width;
-                swapchain.height = (int32_t) swapchainCreateInfo.height;
-                OPENXR_CHECK(xrCreateSwapchain(m_session, &swapchainCreateInfo, &swapchain.handle));
-
-                m_swapchains.push_back(swapchain);
-
-                uint32_t imageCount;
-                OPENXR_CHECK(xrEnumerateSwapchainImages(swapchain.handle, 0, &imageCount, nullptr));
-                ALOGV("[OpenXR]imageCount:%d", imageCount);
-                std::vector<XrSwapchainImageBaseHeader *> swapchainImages;
-                std::vector<XrSwapchainImageOpenGLESKHR> swapchainImageBuffer(imageCount);
-                for (XrSwapchainImageOpenGLESKHR &image : swapchainImageBuffer) {
-                    image.type = XR_TYPE_SWAPCHAIN_IMAGE_OPENGL_ES_KHR;
-                    swapchainImages.push_back(
-                            reinterpret_cast<XrSwapchainImageBaseHeader *>(&image));
-                }
-                m_swapchainImageBuffers.push_back(std::move(swapchainImageBuffer));
-                OPENXR_CHECK(xrEnumerateSwapchainImages(swapchain.handle, imageCount, &imageCount,
-                                                        swapchainImages[0]));
-                m_swapchainImages.insert(
-                        std::make_pair(swapchain.handle, std::move(swapchainImages)));
+            OPENXR_CHECK(createSwapchains());
+        }
+        return XR_SUCCESS;
+    }
+
+    XrReferenceSpaceType OpenXR::getTrackingSpaceType() const {
+        uint32_t spaceCount = 0;
+        OPENXR_CHECK(xrEnumerateReferenceSpaces(m_session, 0, &spaceCount, nullptr));
+        std::vector<XrReferenceSpaceType> spaces(spaceCount);
+        OPENXR_CHECK(xrEnumerateReferenceSpaces(m_session, spaceCount, &spaceCount, spaces.data()));
+        // The server places the head above a floor at y = 0, the way a standing SteamVR
+        // universe does. LOCAL has its origin at the head instead, which still tracks.
+        if (std::find(spaces.begin(), spaces.end(), XR_REFERENCE_SPACE_TYPE_STAGE) !=
+            spaces.end()) {
+            return XR_REFERENCE_SPACE_TYPE_STAGE;
+        }
+        ALOGW("[OpenXR]No STAGE space, poses are sent relative to the LOCAL origin");
+        return XR_REFERENCE_SPACE_TYPE_LOCAL;
+    }
+
+    XrResult OpenXR::createSwapchains() {
+        // Multiview draws every view into its own layer of a single swapchain.
+        const auto viewCount = (uint32_t) m_configViews.size();
+        const uint32_t swapchainCount = m_multiview ? 1 : viewCount;
+        for (uint32_t i = 0; i < swapchainCount; i++) {
+            const XrViewConfigurationView &vp = m_configViews[i];
+            ALOGV("[OpenXR]Creating swapchain for view %d with dimensions Width=%d Height=%d SampleCount=%d ArraySize=%d",
+                  i,
+                  vp.recommendedImageRectWidth, vp.recommendedImageRectHeight,
+                  vp.recommendedSwapchainSampleCount, m_multiview ? viewCount : 1);
+            // Create the swapchain.
+            XrSwapchainCreateInfo swapchainCreateInfo{XR_TYPE_SWAPCHAIN_CREATE_INFO};
+            swapchainCreateInfo.arraySize = m_multiview ? viewCount : 1;
+            swapchainCreateInfo.format = m_colorSwapchainFormat;
+            swapchainCreateInfo.width = vp.recommendedImageRectWidth;
+            swapchainCreateInfo.height = vp.recommendedImageRectHeight;
+            swapchainCreateInfo.mipCount = 1;
+            swapchainCreateInfo.faceCount = 1;
+            swapchainCreateInfo.sampleCount = vp.recommendedSwapchainSampleCount;
+            swapchainCreateInfo.usageFlags =
+                    XR_SWAPCHAIN_USAGE_SAMPLED_BIT | XR_SWAPCHAIN_USAGE_COLOR_ATTACHMENT_BIT;
+            Swapchain swapchain{};
+            swapchain.width = (int32_t) swapchainCreateInfo.width;
+            swapchain.height = (int32_t) swapchainCreateInfo.height;
+            OPENXR_CHECK(xrCreateSwapchain(m_session, &swapchainCreateInfo, &swapchain.handle));
+
+            uint32_t imageCount;
+            OPENXR_CHECK(xrEnumerateSwapchainImages(swapchain.handle, 0, &imageCount, nullptr));
+            ALOGV("[OpenXR]imageCount:%d", imageCount);
+            std::vector<XrSwapchainImageOpenGLESKHR> swapchainImages(
+                    imageCount, {XR_TYPE_SWAPCHAIN_IMAGE_OPENGL_ES_KHR});
+            OPENXR_CHECK(xrEnumerateSwapchainImages(
+                    swapchain.handle, imageCount, &imageCount,
+                    reinterpret_cast<XrSwapchainImageBaseHeader *>(swapchainImages.data())));
+            // Attached once here, so the frame loop only ever binds them.
+            for (const XrSwapchainImageOpenGLESKHR &image : swapchainImages) {
+                swapchain.images.push_back(image.image);
+                swapchain.framebuffers.push_back(
+                        createSwapchainFramebuffer(image.image, swapchainCreateInfo.arraySize));
             }
+            // Runtime owned, but ours to size.
+            swapchain.memoryBytes =
+                    (int64_t) swapchain.width * swapchain.height * swapchainCreateInfo.arraySize *
+                    swapchainCreateInfo.sampleCount * imageCount * GpuMemory::RGBA8_BYTES;
+            GpuMemory::allocated("swapchain", swapchain.memoryBytes);
+            m_swapchains.push_back(std::move(swapchain));
         }
         return XR_SUCCESS;
     }
 
+    void OpenXR::destroySwapchains() {
+        for (const Swapchain &swapchain : m_swapchains) {
+            glDeleteFramebuffers((GLsizei) swapchain.framebuffers.size(),
+                                 swapchain.framebuffers.data());
+            xrDestroySwapchain(swapchain.handle);
+            GpuMemory::released("swapchain", swapchain.memoryBytes);
+        }
+        m_swapchains.clear();
+        // Nothing has been released into the new swapchains yet.
+        m_canRepeatLayer = false;
+    }
+
+    bool OpenXR::setMultiview(bool enable) {
+        if (enable && m_glFramebufferTextureMultiviewOVR == nullptr) {
+            enable = loadMultiview();
+        }
+        if (enable == m_multiview) return m_multiview;
+        m_multiview = enable;
+        ALOGD("[OpenXR]multiview %s", m_multiview ? "on" : "off");
+        if (m_session != XR_NULL_HANDLE && !m_swapchains.empty()) {
+            destroySwapchains();
+            OPENXR_CHECK(createSwapchains());
+        }
+        return m_multiview;
+    }
+
+    bool OpenXR::loadMultiview() {
+        if (m_configViews.size() != Side::COUNT) return false;
+        const XrViewConfigurationView &left = m_configViews[Side::LEFT];
+        const XrViewConfigurationView &right = m_configViews[Side::RIGHT];
+        // Layers of one swapchain share a size.
+        if (left.recommendedImageRectWidth != right.recommendedImageRectWidth ||
+            left.recommendedImageRectHeight != right.recommendedImageRectHeight ||
+            left.recommendedSwapchainSampleCount != right.recommendedSwapchainSampleCount) {
+            ALOGW("[OpenXR]Views differ in size, multiview unavailable");
+            return false;
+        }
+        const char *extensions = reinterpret_cast<const char *>(glGetString(GL_EXTENSIONS));
+        GLint maxViews = 0;
+        glGetIntegerv(GL_MAX_VIEWS_OVR, &maxViews);
+        if (extensions == nullptr || strstr(extensions, "GL_OVR_multiview2") == nullptr ||
+            maxViews < (GLint) Side::COUNT) {
+            ALOGW("[OpenXR]GL_OVR_multiview2 unsupported, multiview unavailable");
+            return false;
+        }
+        m_glFramebufferTextureMultiviewOVR =
+                reinterpret_cast<PFNGLFRAMEBUFFERTEXTUREMULTIVIEWOVRPROC>(
+                        eglGetProcAddress("glFramebufferTextureMultiviewOVR"));
+        return m_glFramebufferTextureMultiviewOVR != nullptr;
+    }
+
     const XrEventDataBaseHeader *OpenXR::tryReadNextEvent() {
         // It is sufficient to clear the just the XrEventDataBuffer header to
         // XR_TYPE_EVENT_DATA_BUFFER
@@ -472,36 +441,16 @@ namespace ssnwt {
 
     XrResult OpenXR::release() {
         ALOGD("[OpenXR]release");
-        for (auto &m_swapchain : m_swapchains) {
-            xrDestroySwapchain(m_swapchain.handle);
-        }
+        destroySwapchains();
         if (m_appSpace != XR_NULL_HANDLE) xrDestroySpace(m_appSpace);
+        if (m_trackingSpace != XR_NULL_HANDLE) xrDestroySpace(m_trackingSpace);
 
         xrDestroySpace(m_input.handSpace[Side::LEFT]);
         xrDestroySpace(m_input.handSpace[Side::RIGHT]);
 
-        if (m_input.primaryButtonAction != XR_NULL_HANDLE)
-            xrDestroyAction(m_input.primaryButtonAction);
-        if (m_input.secondaryButtonAction != XR_NULL_HANDLE)
-            xrDestroyAction(m_input.secondaryButtonAction);
-        if (m_input.gripPressedAction != XR_NULL_HANDLE) xrDestroyAction(m_input.gripPressedAction);
-        if (m_input.menuAction != XR_NULL_HANDLE) xrDestroyAction(m_input.menuAction);
-        if (m_input.triggerPressedAction != XR_NULL_HANDLE)
-            xrDestroyAction(m_input.triggerPressedAction);
-        if (m_input.triggerTouchedAction != XR_NULL_HANDLE)
-            xrDestroyAction(m_input.triggerTouchedAction);
-        if (m_input.thumbstickTouchedAction != XR_NULL_HANDLE)
-            xrDestroyAction(m_input.thumbstickTouchedAction);
-        if (m_input.gripAction != XR_NULL_HANDLE) xrDestroyAction(m_input.gripAction);
-        if (m_input.triggerAction != XR_NULL_HANDLE) xrDestroyAction(m_input.triggerAction);
-        if (m_input.thumbstickAction != XR_NULL_HANDLE) xrDestroyAction(m_input.thumbstickAction);
-        if (m_input.poseAction != XR_NULL_HANDLE) xrDestroyAction(m_input.poseAction);
-        if (m_input.hapticAction != XR_NULL_HANDLE) xrDestroyAction(m_input.hapticAction);
-
-        if (m_input.EnterButtonAction != XR_NULL_HANDLE) xrDestroyAction(m_input.EnterButtonAction);
-        if (m_input.HomeButtonAction != XR_NULL_HANDLE) xrDestroyAction(m_input.HomeButtonAction);
-        if (m_input.VolumeDownAction != XR_NULL_HANDLE) xrDestroyAction(m_input.VolumeDownAction);
-        if (m_input.VolumeUpAction != XR_NULL_HANDLE) xrDestroyAction(m_input.VolumeUpAction);
+        for (XrAction action : m_input.actions) {
+            if (action != XR_NULL_HANDLE) xrDestroyAction(action);
+        }
 
         if (m_input.actionSet != XR_NULL_HANDLE) xrDestroyActionSet(m_input.actionSet);
         if (m_session != XR_NULL_HANDLE) xrDestroySession(m_session);
@@ -524,11 +473,14 @@ namespace ssnwt {
                             XrSessionBeginInfo sessionBeginInfo{XR_TYPE_SESSION_BEGIN_INFO};
                             sessionBeginInfo.primaryViewConfigurationType = XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO;
                             sessionBeginInfo.next = p_NativeWindow;//need set NativeWindow
-                            OPENXR_CHECK(xrBeginSession(m_session, &sessionBeginInfo));
+                            m_sessionRunning = XR_SUCCEEDED(
+                                    xrBeginSession(m_session, &sessionBeginInfo));
+                            CHECK(m_sessionRunning);
                             break;
                         }
                         case XR_SESSION_STATE_STOPPING: {
                             CHECK(m_session != XR_NULL_HANDLE);
+                            m_sessionRunning = false;
                             OPENXR_CHECK(xrEndSession(m_session));
                             break;
                         }
@@ -558,171 +510,276 @@ namespace ssnwt {
         }
     }
 
-    XrResult OpenXR::getControllerState(uint32_t side, uint32_t *booleanComps,
-                                        uint32_t *booleanCompsChanged, float *scalarComps) {
-        const uint32_t priorCompsState = *booleanComps;
+    XrTime OpenXR::getCurrentTime() const {
+        struct timespec now{};
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        XrTime time;
+        if (m_pfnConvertTimespecTimeToTime != nullptr &&
+            XR_SUCCEEDED(m_pfnConvertTimespecTimeToTime(m_instance, &now, &time))) {
+            return time;
+        }
+        return (XrTime) now.tv_sec * 1000000000LL + now.tv_nsec;
+    }
 
-        XrActionStateGetInfo getInfo{XR_TYPE_ACTION_STATE_GET_INFO};
-        getInfo.subactionPath = m_input.handSubactionPath[side];
-
-        getInfo.action = m_input.poseAction;
-        XrActionStatePose poseState{XR_TYPE_ACTION_STATE_POSE};
-        OPENXR_CHECK(xrGetActionStatePose(m_session, &getInfo, &poseState));
-        if (poseState.isActive == XR_FALSE) return XR_EVENT_UNAVAILABLE;
-
-        getInfo.action = m_input.primaryButtonAction;
-        XrActionStateBoolean primaryButtonValue{XR_TYPE_ACTION_STATE_BOOLEAN};
-        OPENXR_CHECK(xrGetActionStateBoolean(m_session, &getInfo, &primaryButtonValue));
-        if (primaryButtonValue.isActive == XR_TRUE && primaryButtonValue.currentState) {
-            *booleanComps |= ButtonMaskFromId(cxrButton_A);
-            ALOGD("Button_A/X -> Down");
-        } else if (*booleanComps & ButtonMaskFromId(cxrButton_A)) {
-            *booleanComps ^= ButtonMaskFromId(cxrButton_A);
-            ALOGD("Button_A/X -> Up");
-        }
-
-        getInfo.action = m_input.secondaryButtonAction;
-        XrActionStateBoolean secondaryButtonValue{XR_TYPE_ACTION_STATE_BOOLEAN};
-        OPENXR_CHECK(xrGetActionStateBoolean(m_session, &getInfo, &secondaryButtonValue));
-        if (secondaryButtonValue.isActive == XR_TRUE && secondaryButtonValue.currentState) {
-            *booleanComps |= ButtonMaskFromId(cxrButton_B);
-            ALOGD("Button_B/Y -> Down");
-        } else if (*booleanComps & ButtonMaskFromId(cxrButton_B)) {
-            *booleanComps ^= ButtonMaskFromId(cxrButton_B);
-            ALOGD("Button_B/Y -> Up");
-        }
-
-        getInfo.action = m_input.gripPressedAction;
-        XrActionStateBoolean gripPressedValue{XR_TYPE_ACTION_STATE_BOOLEAN};
-        OPENXR_CHECK(xrGetActionStateBoolean(m_session, &getInfo, &gripPressedValue));
-        if (gripPressedValue.isActive == XR_TRUE && gripPressedValue.currentState) {
-            *booleanComps |= ButtonMaskFromId(cxrButton_Grip_Click);
-            ALOGD("Grip -> Down");
-        } else if (*booleanComps & ButtonMaskFromId(cxrButton_Grip_Click)) {
-            *booleanComps ^= ButtonMaskFromId(cxrButton_Grip_Click);
-            ALOGD("Grip -> Up");
-            scalarComps[cxrAnalog_Grip] = 0;
-        }
-
-        getInfo.action = m_input.menuAction;
-        XrActionStateBoolean menuValue{XR_TYPE_ACTION_STATE_BOOLEAN};
-        OPENXR_CHECK(xrGetActionStateBoolean(m_session, &getInfo, &menuValue));
-        if (menuValue.isActive == XR_TRUE && menuValue.currentState) {
-            *booleanComps |= ButtonMaskFromId(cxrButton_System);
-            ALOGD("System -> Down");
-        } else if (*booleanComps & ButtonMaskFromId(cxrButton_System)) {
-            *booleanComps ^= ButtonMaskFromId(cxrButton_System);
-            ALOGD("System -> Up");
-        }
-
-        getInfo.action = m_input.triggerPressedAction;
-        XrActionStateBoolean triggerPressedValue{XR_TYPE_ACTION_STATE_BOOLEAN};
-        OPENXR_CHECK(xrGetActionStateBoolean(m_session, &getInfo, &triggerPressedValue));
-        if (triggerPressedValue.isActive == XR_TRUE && triggerPressedValue.currentState) {
-            *booleanComps |= ButtonMaskFromId(cxrButton_Trigger_Click);
-            ALOGD("Trigger -> Down");
-        } else if (*booleanComps & ButtonMaskFromId(cxrButton_Trigger_Click)) {
-            *booleanComps ^= ButtonMaskFromId(cxrButton_Trigger_Click);
-            ALOGD("Trigger -> Up");
-            scalarComps[cxrAnalog_Trigger] = 0;
-        }
-
-        getInfo.action = m_input.thumbstickClickedAction;
-        XrActionStateBoolean thumbstickClickedValue{XR_TYPE_ACTION_STATE_BOOLEAN};
-        OPENXR_CHECK(xrGetActionStateBoolean(m_session, &getInfo, &thumbstickClickedValue));
-        if (thumbstickClickedValue.isActive == XR_TRUE && thumbstickClickedValue.currentState) {
-            *booleanComps |= ButtonMaskFromId(cxrButton_Joystick_Click);
-            ALOGD("Touchpad -> Down");
-        } else if (*booleanComps & ButtonMaskFromId(cxrButton_Joystick_Click)) {
-            *booleanComps ^= ButtonMaskFromId(cxrButton_Joystick_Click);
-            ALOGD("Touchpad -> Up");
-            scalarComps[cxrAnalog_TouchpadX] = 0;
-            scalarComps[cxrAnalog_TouchpadY] = 0;
-        }
-
-        getInfo.action = m_input.thumbstickTouchedAction;
-        XrActionStateBoolean thumbstickTouchedValue{XR_TYPE_ACTION_STATE_BOOLEAN};
-        OPENXR_CHECK(xrGetActionStateBoolean(m_session, &getInfo, &thumbstickTouchedValue));
-        if (thumbstickTouchedValue.isActive == XR_TRUE && thumbstickTouchedValue.currentState) {
-            *booleanComps |= ButtonMaskFromId(cxrButton_Joystick_Touch);
-        } else if (*booleanComps & ButtonMaskFromId(cxrButton_Joystick_Touch)) {
-            *booleanComps ^= ButtonMaskFromId(cxrButton_Joystick_Touch);
-        }
-
-        getInfo.action = m_input.triggerTouchedAction;
-        XrActionStateBoolean triggerTouchedValue{XR_TYPE_ACTION_STATE_BOOLEAN};
-        OPENXR_CHECK(xrGetActionStateBoolean(m_session, &getInfo, &triggerTouchedValue));
-        if (triggerTouchedValue.isActive == XR_TRUE && triggerTouchedValue.currentState) {
-            *booleanComps |= ButtonMaskFromId(cxrButton_Trigger_Touch);
-        } else if (*booleanComps & ButtonMaskFromId(cxrButton_Trigger_Touch)) {
-            *booleanComps ^= ButtonMaskFromId(cxrButton_Trigger_Touch);
-        }
-
-        getInfo.action = m_input.gripAction;
-        XrActionStateFloat gripValue{XR_TYPE_ACTION_STATE_FLOAT};
-        OPENXR_CHECK(xrGetActionStateFloat(m_session, &getInfo, &gripValue));
-        if (gripValue.isActive == XR_TRUE) {
-            scalarComps[cxrAnalog_Grip] = gripValue.currentState;
-        } else {
-            scalarComps[cxrAnalog_Grip] = 0;
+    XrTime OpenXR::getTrackingTime() const {
+        const XrTime now = getCurrentTime();
+        if (m_poseTimeMode != PoseTimeMode::PredictedDisplay || m_predictedDisplayPeriod <= 0) {
+            return now + TRACKING_LOOKAHEAD_NS;
+        }
+        // The next vsync the runtime will display, the last predicted one may be gone already.
+        XrTime time = m_predictedDisplayTime;
+        if (time < now) {
+            time += ((now - time) / m_predictedDisplayPeriod + 1) * m_predictedDisplayPeriod;
         }
+        return time;
+    }
 
-        getInfo.action = m_input.triggerAction;
-        XrActionStateFloat triggerValue{XR_TYPE_ACTION_STATE_FLOAT};
-        OPENXR_CHECK(xrGetActionStateFloat(m_session, &getInfo, &triggerValue));
-        if (triggerValue.isActive == XR_TRUE) {
-            scalarComps[cxrAnalog_Trigger] = triggerValue.currentState;
-        } else {
-            scalarComps[cxrAnalog_Trigger] = 0;
+    void OpenXR::onFrameLatched(const cxrMatrix34 &poseMatrix) {
+        m_latchTime = getCurrentTime();
+        const XrQuaternionf rendered = quaternionFromMatrix(poseMatrix);
+        m_latchedPose = {rendered, {poseMatrix.m[0][3], poseMatrix.m[1][3], poseMatrix.m[2][3]}};
+        m_hasLatchedPose = true;
+        if (m_poseTimeMode != PoseTimeMode::PredictedDisplay) return;
+        const uint32_t count = m_poseHistory.size();
+        if (count == 0) return;
+        const DevicePose &latest = m_poseHistory.at(count - 1).devices[Device::HMD];
+        const XrVector3f &w = latest.angularVelocity;
+        if (!latest.valid ||
+            w.x * w.x + w.y * w.y + w.z * w.z < MIN_MATCH_ANGULAR_SPEED * MIN_MATCH_ANGULAR_SPEED) {
+            return;
         }
 
-        getInfo.action = m_input.thumbstickAction;
-        XrActionStateVector2f thumbstickValue{XR_TYPE_ACTION_STATE_VECTOR2F};
-        OPENXR_CHECK(xrGetActionStateVector2f(m_session, &getInfo, &thumbstickValue));
-        if (thumbstickValue.isActive == XR_TRUE) {
-            scalarComps[cxrAnalog_TouchpadX] = thumbstickValue.currentState.x;
-            scalarComps[cxrAnalog_TouchpadY] = thumbstickValue.currentState.y;
-        } else {
-            scalarComps[cxrAnalog_TouchpadX] = 0;
-            scalarComps[cxrAnalog_TouchpadY] = 0;
+        // The history sample closest to the rendered orientation tells when the head was there.
+        float bestDot = -1;
+        XrTime bestTime = 0;
+        uint32_t bestIndex = 0;
+        for (uint32_t i = count > MATCH_SAMPLE_COUNT ? count - MATCH_SAMPLE_COUNT : 0;
+             i < count; i++) {
+            const DevicePose &hmd = m_poseHistory.at(i).devices[Device::HMD];
+            if (!hmd.valid) continue;
+            const XrQuaternionf &q = hmd.pose.orientation;
+            const float dot = fabsf(q.x * rendered.x + q.y * rendered.y +
+                                    q.z * rendered.z + q.w * rendered.w);
+            if (dot > bestDot) {
+                bestDot = dot;
+                bestTime = m_poseHistory.at(i).time;
+                bestIndex = i;
+            }
+        }
+        if (bestTime == 0) return;
+
+        float staleness = (float) (getTrackingTime() - bestTime) * 1e-9f;
+        if (bestIndex == count - 1) {
+            // Rendered pose is at or past the newest sample, the server may be over-extrapolating.
+            // Project the remaining rotation onto the head's angular velocity to get its lead.
+            const XrVector3f r = rotationVectorFromQuaternion(quaternionMultiply(
+                    rendered, quaternionConjugate(latest.pose.orientation)));
+            staleness = -(r.x * w.x + r.y * w.y + r.z * w.z) / (w.x * w.x + w.y * w.y + w.z * w.z);
+        }
+        // Integrate the remaining staleness into the offset the server extrapolates by.
+        m_poseTimeOffset = std::min(std::max(m_poseTimeOffset + POSE_TIME_OFFSET_GAIN * staleness,
+                                             0.f), MAX_POSE_TIME_OFFSET);
+    }
+
+    void OpenXR::setStreamProjection(const float proj[2][4]) {
+        memcpy(m_streamProjection, proj, sizeof(m_streamProjection));
+        m_hasStreamProjection = true;
+    }
+
+    bool OpenXR::getViewWarp(uint32_t eye, float warp[9]) const {
+        if (m_reprojection != Reprojection::Shader || !m_hasStreamProjection ||
+            !m_hasLatchedPose || !m_displayHeadValid || eye >= m_views.size()) {
+            return false;
+        }
+        const XrView &view = m_views[eye];
+        const XrQuaternionf displayed = quaternionMultiply(m_displayHeadOrientation,
+                                                           view.pose.orientation);
+        reprojectionWarp(m_latchedPose.orientation, displayed, view.fov, m_streamProjection[eye],
+                         warp);
+        return true;
+    }
+
+    XrResult OpenXR::locateDevices(PoseSample *sample, PoseSample *measured) {
+        const XrTime time = getTrackingTime();
+        sample->time = time;
+        const XrResult res = locateDevice(m_appSpace, time, m_hmdVelocity,
+                                          &sample->devices[Device::HMD]);
+        for (int side = 0; side < Side::COUNT; side++) {
+            locateDevice(m_input.handSpace[side], time, m_handVelocity[side],
+                         &sample->devices[Device::LEFT_HAND + side]);
+        }
+        // The history keeps what was measured, latched poses are matched against it.
+        m_poseHistory.push(*sample);
+        m_posePredictor.addSample(*sample);
+        if (measured != nullptr) *measured = *sample;
+        if (m_posePredictor.getModel() != PredictionModel::None) {
+            m_posePredictor.predict(time + (XrDuration) (m_poseTimeOffset * 1e9f), sample);
+        }
+        return res;
+    }
+
+    XrResult OpenXR::locateDevice(XrSpace space, XrTime time, VelocityEstimator &estimator,
+                                  DevicePose *device) {
+        XrSpaceVelocity velocity{XR_TYPE_SPACE_VELOCITY};
+        XrSpaceLocation location{XR_TYPE_SPACE_LOCATION};
+        location.next = &velocity;
+        *device = {};
+        device->pose.orientation.w = 1.f;
+        const XrResult res = xrLocateSpace(space, m_trackingSpace, time, &location);
+        if (res != XR_SUCCESS) {
+            estimator.reset();
+            return res;
+        }
+        // Some runtimes ignore the chained velocity, fall back to differencing the poses.
+        estimator.update(time, location, &velocity);
+
+        // 3DoF devices only report orientation, which is still worth sending.
+        device->valid = (location.locationFlags & XR_SPACE_LOCATION_ORIENTATION_VALID_BIT) != 0;
+        device->pose = location.pose;
+        if (velocity.velocityFlags & XR_SPACE_VELOCITY_LINEAR_VALID_BIT) {
+            device->linearVelocity = velocity.linearVelocity;
+        }
+        if (velocity.velocityFlags & XR_SPACE_VELOCITY_ANGULAR_VALID_BIT) {
+            device->angularVelocity = velocity.angularVelocity;
+        }
+        return res;
+    }
+
+    XrResult OpenXR::getControllerStates(std::array<ControllerState, Side::COUNT> *states) {
+        XrActionStateGetInfo getInfo{XR_TYPE_ACTION_STATE_GET_INFO};
+        XrActionStateBoolean booleanValue{XR_TYPE_ACTION_STATE_BOOLEAN};
+        XrActionStateFloat floatValue{XR_TYPE_ACTION_STATE_FLOAT};
+        XrActionStateVector2f vector2fValue{XR_TYPE_ACTION_STATE_VECTOR2F};
+        for (int side = 0; side < Side::COUNT; side++) {
+            ControllerState &state = (*states)[side];
+            uint32_t booleanComps = 0;
+            memset(state.scalarComps, 0, sizeof(state.scalarComps));
+            getInfo.subactionPath = m_input.handSubactionPath[side];
+            for (uint32_t i = 0; i < Action::COUNT; i++) {
+                const ActionInfo &info = ACTIONS[i];
+                if (info.component < 0) continue;
+                getInfo.action = m_input.actions[i];
+                switch (info.type) {
+                    case XR_ACTION_TYPE_BOOLEAN_INPUT:
+                        if (XR_SUCCEEDED(xrGetActionStateBoolean(m_session, &getInfo, &booleanValue)) &&
+                            booleanValue.isActive && booleanValue.currentState) {
+                            booleanComps |= ButtonMaskFromId((cxrButtonId) info.component);
+                        }
+                        break;
+                    case XR_ACTION_TYPE_FLOAT_INPUT:
+                        if (XR_SUCCEEDED(xrGetActionStateFloat(m_session, &getInfo, &floatValue)) &&
+                            floatValue.isActive) {
+                            state.scalarComps[info.component] = floatValue.currentState;
+                        }
+                        break;
+                    case XR_ACTION_TYPE_VECTOR2F_INPUT:
+                        if (XR_SUCCEEDED(xrGetActionStateVector2f(m_session, &getInfo, &vector2fValue)) &&
+                            vector2fValue.isActive) {
+                            state.scalarComps[info.component] = vector2fValue.currentState.x;
+                            state.scalarComps[info.component + 1] = vector2fValue.currentState.y;
+                        }
+                        break;
+                    default:
+                        break;
+                }
+            }
+            ButtonTracker &tracker = m_buttonTrackers[side];
+            // Edges are filled per packet by PacketEdges, not per sample.
+            state.booleanComps = tracker.update(booleanComps);
         }
-        // update changed flags based on change in comps, as XOR of prior state and new state.
-        *booleanCompsChanged = priorCompsState ^ (*booleanComps);
         return XR_SUCCESS;
     }
 
-    XrResult OpenXR::render() {
+    XrResult OpenXR::waitFrame() {
         processEvent();
         CHECK(m_session != XR_NULL_HANDLE);
 
+        m_frameState = {XR_TYPE_FRAME_STATE};
+        if (!m_sessionRunning) {
+            // Nothing blocks the loop until the runtime asks for frames.
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            return XR_ERROR_SESSION_NOT_RUNNING;
+        }
         XrFrameWaitInfo frameWaitInfo{XR_TYPE_FRAME_WAIT_INFO};
-        XrFrameState frameState{XR_TYPE_FRAME_STATE};
-        OPENXR_CHECK(xrWaitFrame(m_session, &frameWaitInfo, &frameState));
+        OPENXR_CHECK(xrWaitFrame(m_session, &frameWaitInfo, &m_frameState));
+        m_predictedDisplayTime = m_frameState.predictedDisplayTime;
+        m_predictedDisplayPeriod = m_frameState.predictedDisplayPeriod;
+        return XR_SUCCESS;
+    }
 
+    XrResult OpenXR::beginFrame() {
+        if (!m_sessionRunning) return XR_ERROR_SESSION_NOT_RUNNING;
         XrFrameBeginInfo frameBeginInfo{XR_TYPE_FRAME_BEGIN_INFO};
         OPENXR_CHECK(xrBeginFrame(m_session, &frameBeginInfo));
+        return XR_SUCCESS;
+    }
 
-        std::vector<XrCompositionLayerBaseHeader *> layers;
-        XrCompositionLayerProjection layer{XR_TYPE_COMPOSITION_LAYER_PROJECTION};
-        if (frameState.shouldRender == XR_TRUE) {
-            if (RenderLayer(frameState.predictedDisplayTime, layer)) {
-                layers.push_back(reinterpret_cast<XrCompositionLayerBaseHeader *>(&layer));
+    XrResult OpenXR::endFrame() {
+        if (!m_sessionRunning) {
+            m_latchTime = 0;
+            return XR_ERROR_SESSION_NOT_RUNNING;
+        }
+        const bool fresh = m_latchTime != 0;
+        // The only layer there is, m_layer and the views it points at outlive the frame.
+        const XrCompositionLayerBaseHeader *layers[] = {
+                reinterpret_cast<XrCompositionLayerBaseHeader *>(&m_layer)};
+        uint32_t layerCount = 0;
+        if (m_frameState.shouldRender == XR_TRUE) {
+            if (!fresh && m_canRepeatLayer && m_reprojection != Reprojection::Shader) {
+                // No new stream frame. The runtime still holds the images released last and
+                // reprojects them as submitted, only the shader reprojection needs a redraw.
+                layerCount = 1;
+            } else if (RenderLayer(m_frameState.predictedDisplayTime, m_layer)) {
+                layerCount = 1;
+                m_canRepeatLayer = fresh;
             }
         }
 
         XrFrameEndInfo frameEndInfo{XR_TYPE_FRAME_END_INFO};
-        frameEndInfo.displayTime = frameState.predictedDisplayTime;
+        frameEndInfo.displayTime = m_frameState.predictedDisplayTime;
         frameEndInfo.environmentBlendMode = XR_ENVIRONMENT_BLEND_MODE_OPAQUE;
-        frameEndInfo.layerCount = (uint32_t) layers.size();
-        frameEndInfo.layers = layers.data();
+        frameEndInfo.layerCount = layerCount;
+        frameEndInfo.layers = layers;
         OPENXR_CHECK(xrEndFrame(m_session, &frameEndInfo));
 
+        if (layerCount > 0 && m_hasLatchedPose) updateFrameStats(fresh);
+        m_latchTime = 0;
         return XR_SUCCESS;
     }
 
+    void OpenXR::onStreamStopped() {
+        m_hasLatchedPose = false;
+        m_canRepeatLayer = false;
+        m_latchTime = 0;
+    }
+
+    void OpenXR::updateFrameStats(bool fresh) {
+        if (fresh) {
+            const XrDuration age = m_frameState.predictedDisplayTime - m_latchTime;
+            m_freshFrames++;
+            m_latchAgeSum += age;
+            m_latchAgeMax = std::max(m_latchAgeMax, age);
+        } else {
+            m_repeatedFrames++;
+        }
+        const XrTime now = getCurrentTime();
+        if (m_frameStatsLogTime == 0) m_frameStatsLogTime = now;
+        if (now - m_frameStatsLogTime < FRAME_STATS_LOG_PERIOD_NS) return;
+        ALOGD("[OpenXR]frames fresh %u, repeated %u, latch to display age mean %.2f ms, max %.2f ms",
+              m_freshFrames, m_repeatedFrames,
+              m_freshFrames > 0 ? (double) m_latchAgeSum / m_freshFrames * 1e-6 : 0.0,
+              (double) m_latchAgeMax * 1e-6);
+        m_frameStatsLogTime = now;
+        m_freshFrames = 0;
+        m_repeatedFrames = 0;
+        m_latchAgeSum = 0;
+        m_latchAgeMax = 0;
+    }
+
     bool OpenXR::RenderLayer(XrTime predictedDisplayTime, XrCompositionLayerProjection &layer) {
         XrResult res;
-        std::vector<XrCompositionLayerProjectionView> projectionLayerViews;
+        // Kept past endFrame(), a repeated layer points at them again.
+        std::vector<XrCompositionLayerProjectionView> &projectionLayerViews = m_projectionLayerViews;
         XrViewState viewState{XR_TYPE_VIEW_STATE};
         auto viewCapacityInput = (uint32_t) m_views.size();
         uint32_t viewCountOutput;
@@ -740,26 +797,52 @@ namespace ssnwt {
             return false;  // There is no valid tracking poses for the views.
         }
 
+        // Where the head will be when these views are shown, to reproject the latched frame to.
+        XrSpaceLocation headLocation{XR_TYPE_SPACE_LOCATION};
+        m_displayHeadValid = xrLocateSpace(m_appSpace, m_trackingSpace, predictedDisplayTime,
+                                           &headLocation) == XR_SUCCESS &&
+                             (headLocation.locationFlags & XR_SPACE_LOCATION_ORIENTATION_VALID_BIT);
+        m_displayHeadOrientation = headLocation.pose.orientation;
+
         CHECK(viewCountOutput == viewCapacityInput);
         CHECK(viewCountOutput == m_configViews.size());
-        CHECK(viewCountOutput == m_swapchains.size());
+        CHECK(m_swapchains.size() == (m_multiview ? 1 : viewCountOutput));
 
         projectionLayerViews.resize(viewCountOutput);
 
-        // Render view to the appropriate part of the swapchain image.
-        for (uint32_t i = 0; i < viewCountOutput; i++) {
-            // Each view has a separate swapchain which is acquired, rendered to, and released.
-            const Swapchain viewSwapchain = m_swapchains[i];
+        if (m_multiview) {
+            // Every view is a layer of one swapchain image, drawn in a single pass.
+            const Swapchain &swapchain = m_swapchains[0];
+            const uint32_t imageIndex = AcquireSwapchainImage(swapchain);
+            for (uint32_t i = 0; i < viewCountOutput; i++) {
+                projectionLayerViews[i] = {XR_TYPE_COMPOSITION_LAYER_PROJECTION_VIEW};
+                projectionLayerViews[i].pose = m_views[i].pose;
+                projectionLayerViews[i].fov = m_views[i].fov;
+                projectionLayerViews[i].subImage.swapchain = swapchain.handle;
+                projectionLayerViews[i].subImage.imageRect.offset = {0, 0};
+                projectionLayerViews[i].subImage.imageRect.extent = {swapchain.width,
+                                                                     swapchain.height};
+                projectionLayerViews[i].subImage.imageArrayIndex = i;
+            }
+            RenderView(projectionLayerViews[0].subImage.imageRect,
+                       swapchain.framebuffers[imageIndex]);
 
-            XrSwapchainImageAcquireInfo acquireInfo{XR_TYPE_SWAPCHAIN_IMAGE_ACQUIRE_INFO};
+            glClearColor(0, 0, 0, 1);
+            glClear(GL_COLOR_BUFFER_BIT);
+            if (m_draw_frame_cb) {
+                m_draw_frame_cb(ALL_VIEWS);
+            }
 
-            uint32_t swapchainImageIndex;
-            OPENXR_CHECK(xrAcquireSwapchainImage(viewSwapchain.handle, &acquireInfo,
-                                                 &swapchainImageIndex));
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            XrSwapchainImageReleaseInfo releaseInfo{XR_TYPE_SWAPCHAIN_IMAGE_RELEASE_INFO};
+            OPENXR_CHECK(xrReleaseSwapchainImage(swapchain.handle, &releaseInfo));
+        }
 
-            XrSwapchainImageWaitInfo waitInfo{XR_TYPE_SWAPCHAIN_IMAGE_WAIT_INFO};
-            waitInfo.timeout = XR_INFINITE_DURATION;
-            OPENXR_CHECK(xrWaitSwapchainImage(viewSwapchain.handle, &waitInfo));
+        // Render view to the appropriate part of the swapchain image.
+        for (uint32_t i = 0; i < viewCountOutput && !m_multiview; i++) {
+            // Each view has a separate swapchain which is acquired, rendered to, and released.
+            const Swapchain &viewSwapchain = m_swapchains[i];
+            const uint32_t imageIndex = AcquireSwapchainImage(viewSwapchain);
 
             projectionLayerViews[i] = {XR_TYPE_COMPOSITION_LAYER_PROJECTION_VIEW};
             projectionLayerViews[i].pose = m_views[i].pose;
@@ -768,17 +851,11 @@ namespace ssnwt {
             projectionLayerViews[i].subImage.imageRect.offset = {0, 0};
             projectionLayerViews[i].subImage.imageRect.extent = {viewSwapchain.width,
                                                                  viewSwapchain.height};
-
-            const XrSwapchainImageBaseHeader *const swapchainImage =
-                    m_swapchainImages[viewSwapchain.handle][swapchainImageIndex];
-            // Texture arrays not supported.
-            CHECK(projectionLayerViews[i].subImage.imageArrayIndex == 0);
-            const uint32_t colorTexture =
-                    reinterpret_cast<const XrSwapchainImageOpenGLESKHR *>(swapchainImage)->image;
-            RenderView(projectionLayerViews[i].subImage.imageRect, colorTexture);
+            RenderView(projectionLayerViews[i].subImage.imageRect,
+                       viewSwapchain.framebuffers[imageIndex]);
 
             glClearColor(0, 0, 0, 1);
-            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            glClear(GL_COLOR_BUFFER_BIT);
             if (m_draw_frame_cb) {
                 m_draw_frame_cb(i);
             }
@@ -789,15 +866,56 @@ namespace ssnwt {
         }
 
         layer.space = m_appSpace;
+        if (m_reprojection == Reprojection::Compositor && m_hasStreamProjection &&
+            m_hasLatchedPose) {
+            // The image is what the server saw from the latched pose, say so and let the
+            // compositor's timewarp move it to where the head is now.
+            layer.space = m_trackingSpace;
+            for (uint32_t i = 0; i < viewCountOutput; i++) {
+                const float *proj = m_streamProjection[i];
+                projectionLayerViews[i].pose = poseMultiply(m_latchedPose, m_views[i].pose);
+                projectionLayerViews[i].fov = {atanf(proj[0]), atanf(proj[1]),
+                                               atanf(-proj[2]), atanf(-proj[3])};
+            }
+        }
         layer.viewCount = (uint32_t) projectionLayerViews.size();
         layer.views = projectionLayerViews.data();
         return true;
     }
 
-    void OpenXR::RenderView(XrRect2Di imageRect, const uint32_t colorTexture) {
-        if (m_swapchainFramebuffer == 0)
-            glGenFramebuffers(1, &m_swapchainFramebuffer);
-        glBindFramebuffer(GL_FRAMEBUFFER, m_swapchainFramebuffer);
+    uint32_t OpenXR::AcquireSwapchainImage(const Swapchain &swapchain) {
+        XrSwapchainImageAcquireInfo acquireInfo{XR_TYPE_SWAPCHAIN_IMAGE_ACQUIRE_INFO};
+
+        uint32_t swapchainImageIndex;
+        OPENXR_CHECK(xrAcquireSwapchainImage(swapchain.handle, &acquireInfo,
+                                             &swapchainImageIndex));
+
+        XrSwapchainImageWaitInfo waitInfo{XR_TYPE_SWAPCHAIN_IMAGE_WAIT_INFO};
+        waitInfo.timeout = XR_INFINITE_DURATION;
+        OPENXR_CHECK(xrWaitSwapchainImage(swapchain.handle, &waitInfo));
+        return swapchainImageIndex;
+    }
+
+    GLuint OpenXR::createSwapchainFramebuffer(GLuint image, uint32_t layerCount) {
+        GLuint framebuffer;
+        glGenFramebuffers(1, &framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        if (layerCount > 1) {
+            m_glFramebufferTextureMultiviewOVR(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, image, 0, 0,
+                                               (GLsizei) layerCount);
+        } else {
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, image, 0);
+        }
+        const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+        if (status != GL_FRAMEBUFFER_COMPLETE) {
+            ALOGE("[OpenXR]swapchain framebuffer incomplete: 0x%x", status);
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        return framebuffer;
+    }
+
+    void OpenXR::RenderView(XrRect2Di imageRect, GLuint framebuffer) {
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
 
         glViewport(static_cast<GLint>(imageRect.offset.x),
                    static_cast<GLint>(imageRect.offset.y),
@@ -806,41 +924,11 @@ namespace ssnwt {
         glFrontFace(GL_CW);
         glCullFace(GL_BACK);
         glEnable(GL_CULL_FACE);
-        glEnable(GL_DEPTH_TEST);
-
-        const uint32_t depthTexture = GetDepthTexture(colorTexture);
-        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
-                               colorTexture, 0);
-        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0);
-    }
-
-    uint32_t OpenXR::GetDepthTexture(uint32_t colorTexture) {
-// If a depth-stencil view has already been created for this back-buffer, use it.
-        auto depthBufferIt = m_colorToDepthMap.find(colorTexture);
-        if (depthBufferIt != m_colorToDepthMap.end()) {
-            return depthBufferIt->second;
-        }
-
-        // This back-buffer has no corresponding depth-stencil texture, so create one with matching dimensions.
-
-        GLint width;
-        GLint height;
-        glBindTexture(GL_TEXTURE_2D, colorTexture);
-        glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width);
-        glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height);
-
-        uint32_t depthTexture;
-        glGenTextures(1, &depthTexture);
-        glBindTexture(GL_TEXTURE_2D, depthTexture);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, width, height, 0,
-                     GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, nullptr);
-
-        m_colorToDepthMap.insert(std::make_pair(colorTexture, depthTexture));
+        // Video only: the stream is a blit or a single quad, nothing to depth test.
+        glDisable(GL_DEPTH_TEST);
 
-        return depthTexture;
+        // Whatever the image held before gets overwritten, don't let a tiler load it.
+        const GLenum attachment = GL_COLOR_ATTACHMENT0;
+        glInvalidateFramebuffer(GL_FRAMEBUFFER, 1, &attachment);
     }
 }
\ No newline at end of file
@@ -5,15 +5,22 @@
 #ifndef CLOUDXR_OPENXR_H
 #define CLOUDXR_OPENXR_H
 
+#include <ctime>
 #include <openxr/openxr.h>
 #include <openxr/openxr_platform.h>
 #include <jni.h>
 #include <android/native_window.h>
+#include <GLES3/gl32.h>
+#include <GLES2/gl2ext.h>
 #include <array>
 #include <map>
 #include <list>
 #include <vector>
 #include <CloudXRCommon.h>
+#include "InputTracker.h"
+#include "PoseHistory.h"
+#include "PosePredictor.h"
+#include "VelocityEstimator.h"
 
 namespace Side {
     const int LEFT = 0;
@@ -24,26 +31,36 @@ struct Swapchain {
     XrSwapchain handle;
     int32_t width;
     int32_t height;
+    int64_t memoryBytes;    // all images, estimated
+    // By image index: the GL texture and a complete framebuffer drawing into it.
+    std::vector<GLuint> images;
+    std::vector<GLuint> framebuffers;
 };
+namespace Action {
+    enum {
+        PrimaryButton,
+        SecondaryButton,
+        GripPressed,
+        Menu,
+        TriggerPressed,
+        TriggerTouched,
+        ThumbstickClicked,
+        ThumbstickTouched,
+        Grip,
+        Trigger,
+        Thumbstick,
+        Pose,
+        Haptic,
+        EnterButton,
+        HomeButton,
+        VolumeDown,
+        VolumeUp,
+        COUNT
+    };
+}  // namespace Action
 struct InputState {
     XrActionSet actionSet{XR_NULL_HANDLE};
-    XrAction thumbstickAction{XR_NULL_HANDLE};
-    XrAction gripAction{XR_NULL_HANDLE};
-    XrAction triggerAction{XR_NULL_HANDLE};
-    XrAction gripPressedAction{XR_NULL_HANDLE};
-    XrAction menuAction{XR_NULL_HANDLE};
-    XrAction primaryButtonAction{XR_NULL_HANDLE};
-    XrAction secondaryButtonAction{XR_NULL_HANDLE};
-    XrAction triggerPressedAction{XR_NULL_HANDLE};
-    XrAction triggerTouchedAction{XR_NULL_HANDLE};
-    XrAction thumbstickClickedAction{XR_NULL_HANDLE};
-    XrAction thumbstickTouchedAction{XR_NULL_HANDLE};
-    XrAction EnterButtonAction{XR_NULL_HANDLE};
-    XrAction HomeButtonAction{XR_NULL_HANDLE};
-    XrAction VolumeDownAction{XR_NULL_HANDLE};
-    XrAction VolumeUpAction{XR_NULL_HANDLE};
-    XrAction poseAction{XR_NULL_HANDLE};
-    XrAction hapticAction{XR_NULL_HANDLE};
+    std::array<XrAction, Action::COUNT> actions{};
     std::array<XrPath, Side::COUNT> handSubactionPath;
     XrPath headSubactionPath;
     std::array<XrSpace, Side::COUNT> handSpace;
@@ -52,6 +69,27 @@ struct InputState {
 namespace ssnwt {
     typedef void (*draw_frame_call_back)(uint32_t);
 
+    // Passed to the draw callback instead of an eye when both are drawn in one multiview pass.
+    constexpr uint32_t ALL_VIEWS = UINT32_MAX;
+
+    struct ControllerState {
+        uint32_t booleanComps;
+        float scalarComps[cxrAnalog_Num];
+    };
+
+    // How a latched frame is corrected for head motion since the server rendered it.
+    // Values match ClientOptions::mReprojection.
+    enum class Reprojection : uint32_t {
+        None = 0,           // shown head-locked, as rendered
+        Compositor = 1,     // submitted world-locked at the latched pose, the runtime reprojects
+        Shader = 2,         // drawn through GraphicRender with reprojectionWarp()
+    };
+
+    enum class PoseTimeMode {
+        Lookahead,          // current time plus a fixed lookahead
+        PredictedDisplay,   // next predicted display time, network delay via poseTimeOffset
+    };
+
     class OpenXR {
     public:
         OpenXR(JavaVM *vm, jobject activity);
@@ -60,24 +98,67 @@ namespace ssnwt {
 
         void setSurface(ANativeWindow *window);
 
-        XrResult render();
+        // One frame is waitFrame(), beginFrame() and endFrame(). A stream frame latched between
+        // the wait and the end is as fresh as it can be when it gets drawn.
+        // Blocks until the runtime wants the next frame and predicts when it will be shown.
+        // Until the session is running all three return XR_ERROR_SESSION_NOT_RUNNING without
+        // calling the runtime.
+        XrResult waitFrame();
+
+        XrResult beginFrame();
+
+        // Draws the views through the callback, if the runtime wants them, and submits them.
+        // Without a frame latched since waitFrame() the last stream layer is submitted again
+        // for the runtime to reproject, unless Reprojection::Shader has to redraw it.
+        XrResult endFrame();
+
+        // The stream is gone, stop repeating its last frame.
+        void onStreamStopped();
 
         XrResult release();
 
-        uint64_t GetTimeInSeconds() {
-            struct timespec now;
-            clock_gettime(CLOCK_MONOTONIC, &now);
-            return now.tv_sec * 1e9 + now.tv_nsec;
-        }
+        // Current time on the runtime's XrTime clock.
+        XrTime getCurrentTime() const;
 
-        XrResult getLocateSpace(XrSpaceLocation *location) {
-            return xrLocateSpace(m_appSpace, m_appSpace, GetTimeInSeconds() + 2000000, location);
-        }
+        // Time the tracking sample for the server is located at.
+        XrTime getTrackingTime() const;
 
-        XrResult getControllerSpace(uint32_t side, XrSpaceLocation *location) {
-            return xrLocateSpace(m_input.handSpace[side], m_appSpace,
-                                 GetTimeInSeconds() + 2000000, location);
-        }
+        void setPoseTimeMode(PoseTimeMode mode) { m_poseTimeMode = mode; }
+
+        // Extra server-side extrapolation in seconds for cxrVRTrackingState::poseTimeOffset.
+        float getPoseTimeOffset() const { return m_poseTimeOffset; }
+
+        // Keep the pose a freshly latched stream frame was rendered at, and measure how stale it is.
+        // Also marks the frame drawn by the next endFrame() fresh and starts its latch to
+        // display age.
+        void onFrameLatched(const cxrMatrix34 &poseMatrix);
+
+        // Per eye stream extents, cxrDeviceDesc::proj.
+        void setStreamProjection(const float proj[2][4]);
+
+        void setReprojection(Reprojection mode) { m_reprojection = mode; }
+
+        // Render both views in one GL_OVR_multiview2 pass into a single array swapchain, the
+        // draw callback then gets ALL_VIEWS. Recreates the swapchains when it changes, returns
+        // false (a swapchain per view) when the driver or the view sizes don't allow it.
+        bool setMultiview(bool enable);
+
+        bool isMultiview() const { return m_multiview; }
+
+        // Reprojection::Shader warp from the view being drawn to the latched frame, see
+        // reprojectionWarp(). Only valid inside the draw callback, returns false when there is
+        // nothing to correct.
+        bool getViewWarp(uint32_t eye, float warp[9]) const;
+
+        // Client-side prediction of the located poses, None leaves it to the server.
+        void setPredictionModel(PredictionModel model) { m_posePredictor.setModel(model); }
+
+        // Locate the HMD and both hands at one time and append them to the pose history.
+        // With a prediction model the returned sample is extrapolated by getPoseTimeOffset(),
+        // measured gets it as located.
+        XrResult locateDevices(PoseSample *sample, PoseSample *measured = nullptr);
+
+        const PoseHistory &getPoseHistory() const { return m_poseHistory; }
 
         XrResult syncAction() {
             // Sync actions
@@ -88,38 +169,92 @@ namespace ssnwt {
             return xrSyncActions(m_session, &syncInfo);
         }
 
-        XrResult getControllerState(uint32_t side, uint32_t *booleanComps,
-                                    uint32_t *booleanCompsChanged, float *scalarComps);
+        // Sample every forwarded action for both hands, syncAction() must have succeeded.
+        XrResult getControllerStates(std::array<ControllerState, Side::COUNT> *states);
+
+        void setButtonDebounce(uint32_t samples) {
+            for (ButtonTracker &tracker : m_buttonTrackers) tracker.setDebounce(samples);
+        }
 
     private:
+        XrResult locateDevice(XrSpace space, XrTime time, VelocityEstimator &estimator,
+                              DevicePose *device);
+
         void processEvent();
 
+        void updateFrameStats(bool fresh);
+
         const XrEventDataBaseHeader *tryReadNextEvent();
 
+        // STAGE when the runtime has one, else LOCAL.
+        XrReferenceSpaceType getTrackingSpaceType() const;
+
+        XrResult createSwapchains();
+
+        void destroySwapchains();
+
+        bool loadMultiview();
+
         bool RenderLayer(XrTime predictedDisplayTime, XrCompositionLayerProjection &layer);
 
-        void RenderView(XrRect2Di imageRect, const uint32_t colorTexture);
+        // Acquires and waits for the next image, returns its index.
+        uint32_t AcquireSwapchainImage(const Swapchain &swapchain);
+
+        // Color only, every layer of image when there is more than one.
+        GLuint createSwapchainFramebuffer(GLuint image, uint32_t layerCount);
 
-        uint32_t GetDepthTexture(uint32_t colorTexture);
+        // Binds one of the swapchain framebuffers for drawing a view, or all views with
+        // multiview.
+        void RenderView(XrRect2Di imageRect, GLuint framebuffer);
 
         XrInstance m_instance{XR_NULL_HANDLE};
         XrSession m_session{XR_NULL_HANDLE};
+        // Between xrBeginSession on READY and xrEndSession on STOPPING.
+        bool m_sessionRunning{false};
         XrSpace m_appSpace{XR_NULL_HANDLE};
+        // World-locked space devices are tracked in and poses are sent to the server in,
+        // m_appSpace is head-locked.
+        XrSpace m_trackingSpace{XR_NULL_HANDLE};
         XrSystemId m_systemId{XR_NULL_SYSTEM_ID};
+        PFN_xrConvertTimespecTimeToTimeKHR m_pfnConvertTimespecTimeToTime{nullptr};
         ANativeWindow *p_NativeWindow{};
 
         InputState m_input{};
+        std::array<ButtonTracker, Side::COUNT> m_buttonTrackers{};
+        VelocityEstimator m_hmdVelocity{};
+        std::array<VelocityEstimator, Side::COUNT> m_handVelocity{};
+        PoseHistory m_poseHistory{};
+        PosePredictor m_posePredictor{};
+        PoseTimeMode m_poseTimeMode{PoseTimeMode::PredictedDisplay};
+        XrFrameState m_frameState{XR_TYPE_FRAME_STATE};
+        XrTime m_predictedDisplayTime{0};
+        XrDuration m_predictedDisplayPeriod{0};
+        float m_poseTimeOffset{0};
+        Reprojection m_reprojection{Reprojection::None};
+        bool m_hasStreamProjection{false};
+        float m_streamProjection[2][4]{};
+        bool m_hasLatchedPose{false};
+        XrPosef m_latchedPose{{0, 0, 0, 1}, {0, 0, 0}};
+        bool m_displayHeadValid{false};
+        XrQuaternionf m_displayHeadOrientation{0, 0, 0, 1};
+        XrTime m_latchTime{0};             // of the frame drawn by the next endFrame(), or 0
+        uint32_t m_freshFrames{0};
+        uint32_t m_repeatedFrames{0};
+        XrDuration m_latchAgeSum{0};
+        XrDuration m_latchAgeMax{0};
+        XrTime m_frameStatsLogTime{0};
         XrEventDataBuffer m_eventDataBuffer{};
 
         std::vector<XrView> m_views{};
+        XrCompositionLayerProjection m_layer{XR_TYPE_COMPOSITION_LAYER_PROJECTION};
+        std::vector<XrCompositionLayerProjectionView> m_projectionLayerViews{};
+        bool m_canRepeatLayer{false};       // m_layer shows a stream frame, released last
         int64_t m_colorSwapchainFormat{-1};
         std::vector<XrViewConfigurationView> m_configViews{};
         std::vector<Swapchain> m_swapchains;
-        std::map<XrSwapchain, std::vector<XrSwapchainImageBaseHeader *>> m_swapchainImages{};
 
-        GLuint m_swapchainFramebuffer{0};
-        std::map<uint32_t, uint32_t> m_colorToDepthMap{};
-        std::list<std::vector<XrSwapchainImageOpenGLESKHR>> m_swapchainImageBuffers{};
+        bool m_multiview{false};
+        PFNGLFRAMEBUFFERTEXTUREMULTIVIEWOVRPROC m_glFramebufferTextureMultiviewOVR{nullptr};
 
         draw_frame_call_back m_draw_frame_cb{0};
     };
@@ -0,0 +1,64 @@
+#include <cmath>
+#include "PoseHistory.h"
+#include "PoseMath.h"
+
+namespace ssnwt {
+    void PoseHistory::clear() {
+        m_head = 0;
+        m_count = 0;
+    }
+
+    void PoseHistory::push(const PoseSample &sample) {
+        if (m_count > 0 && sample.time <= at(m_count - 1).time) return;
+        m_samples[m_head] = sample;
+        m_head = (m_head + 1) % CAPACITY;
+        if (m_count < CAPACITY) m_count++;
+    }
+
+    bool PoseHistory::latest(PoseSample *out) const {
+        if (m_count == 0) return false;
+        *out = at(m_count - 1);
+        return true;
+    }
+
+    bool PoseHistory::sample(XrTime time, PoseSample *out) const {
+        if (m_count == 0) return false;
+        if (time <= at(0).time) {
+            *out = at(0);
+            return true;
+        }
+        if (time >= at(m_count - 1).time) {
+            *out = at(m_count - 1);
+            return true;
+        }
+        // First sample at or after time, the one before it is strictly older.
+        uint32_t lo = 1, hi = m_count - 1;
+        while (lo < hi) {
+            const uint32_t mid = (lo + hi) / 2;
+            if (at(mid).time < time) lo = mid + 1;
+            else hi = mid;
+        }
+        const PoseSample &a = at(lo - 1);
+        const PoseSample &b = at(lo);
+        const float t = (float) (time - a.time) / (float) (b.time - a.time);
+        out->time = time;
+        for (int i = 0; i < Device::COUNT; i++) {
+            interpolate(a.devices[i], b.devices[i], t, &out->devices[i]);
+        }
+        return true;
+    }
+
+    void PoseHistory::interpolate(const DevicePose &a, const DevicePose &b, float t,
+                                  DevicePose *out) {
+        if (!a.valid || !b.valid) {
+            // Never blend with an untracked pose, use the nearer valid one if any.
+            *out = (b.valid && (t >= 0.5f || !a.valid)) ? b : a;
+            return;
+        }
+        out->pose.position = vectorLerp(a.pose.position, b.pose.position, t);
+        out->pose.orientation = quaternionSlerp(a.pose.orientation, b.pose.orientation, t);
+        out->linearVelocity = vectorLerp(a.linearVelocity, b.linearVelocity, t);
+        out->angularVelocity = vectorLerp(a.angularVelocity, b.angularVelocity, t);
+        out->valid = true;
+    }
+}
@@ -0,0 +1,65 @@
+//
+// Fixed-size history of tracked device poses keyed by XrTime.
+//
+
+#ifndef CLOUDXR_POSEHISTORY_H
+#define CLOUDXR_POSEHISTORY_H
+
+#include <openxr/openxr.h>
+#include <array>
+
+namespace Device {
+    const int HMD = 0;
+    const int LEFT_HAND = 1;
+    const int RIGHT_HAND = 2;
+    const int COUNT = 3;
+}  // namespace Device
+
+namespace ssnwt {
+    struct DevicePose {
+        XrPosef pose;
+        XrVector3f linearVelocity;
+        XrVector3f angularVelocity;
+        bool valid;
+    };
+
+    struct PoseSample {
+        XrTime time;
+        std::array<DevicePose, Device::COUNT> devices;
+    };
+
+    class PoseHistory {
+    public:
+        // About one second of samples at 120 Hz.
+        static constexpr uint32_t CAPACITY = 128;
+
+        void clear();
+
+        // Times must increase, a sample not newer than the last one is dropped.
+        void push(const PoseSample &sample);
+
+        // Interpolated sample at time, clamped to the oldest/newest entry.
+        // Returns false when the history is empty.
+        bool sample(XrTime time, PoseSample *out) const;
+
+        bool latest(PoseSample *out) const;
+
+        uint32_t size() const { return m_count; }
+
+        // 0 is the oldest sample, size() - 1 the newest.
+        const PoseSample &at(uint32_t index) const {
+            return m_samples[(m_head + CAPACITY - m_count + index) % CAPACITY];
+        }
+
+    private:
+
+        static void interpolate(const DevicePose &a, const DevicePose &b, float t,
+                                DevicePose *out);
+
+        std::array<PoseSample, CAPACITY> m_samples{};
+        uint32_t m_head{0};
+        uint32_t m_count{0};
+    };
+}
+
+#endif //CLOUDXR_POSEHISTORY_H
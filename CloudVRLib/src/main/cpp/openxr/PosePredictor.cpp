@@ -0,0 +1,221 @@
+#include <cmath>
+#include <algorithm>
+#include "PosePredictor.h"
+#include "PoseMath.h"
+#include "log.h"
+
+namespace ssnwt {
+    // Never extrapolate further than this, errors grow quadratically past it.
+    constexpr float MAX_PREDICTION_HORIZON = 0.1f;
+    // Velocities this far apart give the acceleration for ConstantAcceleration.
+    constexpr XrDuration ACCELERATION_WINDOW_NS = 20000000;
+    // A gap between samples longer than this restarts the Kalman filters.
+    constexpr float MAX_SAMPLE_GAP = 0.1f;
+    // Kalman noise: white acceleration for position, white angular jerk for rotation.
+    constexpr float POSITION_PROCESS_NOISE = 10.f;
+    constexpr float POSITION_MEASUREMENT_NOISE = 1e-6f;
+    constexpr float ANGULAR_PROCESS_NOISE = 500.f;
+    constexpr float ANGULAR_MEASUREMENT_NOISE = 2.5e-3f;
+
+    const char *PredictionModelToString(PredictionModel model) {
+        switch (model) {
+            case PredictionModel::None:
+                return "none";
+            case PredictionModel::ConstantVelocity:
+                return "constant-velocity";
+            case PredictionModel::ConstantAcceleration:
+                return "constant-acceleration";
+            case PredictionModel::Kalman:
+                return "kalman";
+            default:
+                return "";
+        }
+    }
+
+    void PosePredictor::KalmanAxis::reset(float measured, float measurementNoise) {
+        value = measured;
+        rate = 0;
+        p00 = measurementNoise;
+        p01 = 0;
+        p11 = 1.f;
+    }
+
+    void PosePredictor::KalmanAxis::update(float measured, float dt, float processNoise,
+                                           float measurementNoise) {
+        // Predict
+        value += rate * dt;
+        p00 += dt * (2.f * p01 + dt * p11) + processNoise * dt * dt * dt / 3.f;
+        p01 += dt * p11 + processNoise * dt * dt / 2.f;
+        p11 += processNoise * dt;
+        // Correct
+        const float s = p00 + measurementNoise;
+        const float k0 = p00 / s;
+        const float k1 = p01 / s;
+        const float innovation = measured - value;
+        value += k0 * innovation;
+        rate += k1 * innovation;
+        p11 -= k1 * p01;
+        p00 *= 1.f - k0;
+        p01 *= 1.f - k0;
+    }
+
+    void PosePredictor::reset() {
+        m_history.clear();
+        for (KalmanDevice &kalman : m_kalman) kalman.valid = false;
+    }
+
+    void PosePredictor::addSample(const PoseSample &sample) {
+        PoseSample previous;
+        const bool hasPrevious = m_history.latest(&previous);
+        if (hasPrevious && sample.time <= previous.time) return;
+        const float dt = hasPrevious ? (float) (sample.time - previous.time) * 1e-9f : 0.f;
+
+        for (int device = 0; device < Device::COUNT; device++) {
+            const DevicePose &pose = sample.devices[device];
+            KalmanDevice &kalman = m_kalman[device];
+            if (!pose.valid) {
+                kalman.valid = false;
+                continue;
+            }
+            const float position[3] = {pose.pose.position.x, pose.pose.position.y,
+                                       pose.pose.position.z};
+            const float angular[3] = {pose.angularVelocity.x, pose.angularVelocity.y,
+                                      pose.angularVelocity.z};
+            const bool restart = !kalman.valid || dt <= 0 || dt > MAX_SAMPLE_GAP;
+            for (int axis = 0; axis < 3; axis++) {
+                if (restart) {
+                    kalman.position[axis].reset(position[axis], POSITION_MEASUREMENT_NOISE);
+                    kalman.angularVelocity[axis].reset(angular[axis], ANGULAR_MEASUREMENT_NOISE);
+                } else {
+                    kalman.position[axis].update(position[axis], dt, POSITION_PROCESS_NOISE,
+                                                 POSITION_MEASUREMENT_NOISE);
+                    kalman.angularVelocity[axis].update(angular[axis], dt, ANGULAR_PROCESS_NOISE,
+                                                        ANGULAR_MEASUREMENT_NOISE);
+                }
+            }
+            kalman.valid = true;
+        }
+        m_history.push(sample);
+    }
+
+    bool PosePredictor::predict(XrTime time, PoseSample *out) const {
+        if (!m_history.latest(out)) return false;
+        const float dt = std::min(std::max((float) (time - out->time) * 1e-9f, 0.f),
+                                  MAX_PREDICTION_HORIZON);
+        out->time = time;
+        if (m_model == PredictionModel::None || dt <= 0) return true;
+        for (int device = 0; device < Device::COUNT; device++) {
+            if (out->devices[device].valid) predictDevice(device, dt, &out->devices[device]);
+        }
+        return true;
+    }
+
+    void PosePredictor::predictDevice(int device, float dt, DevicePose *pose) const {
+        XrVector3f position = pose->pose.position;
+        XrVector3f velocity = pose->linearVelocity;
+        XrVector3f angularVelocity = pose->angularVelocity;
+        XrVector3f acceleration{0, 0, 0};
+        XrVector3f angularAcceleration{0, 0, 0};
+        if (m_model == PredictionModel::ConstantAcceleration) {
+            estimateAcceleration(device, &acceleration, &angularAcceleration);
+        } else if (m_model == PredictionModel::Kalman && m_kalman[device].valid) {
+            const KalmanDevice &kalman = m_kalman[device];
+            position = {kalman.position[0].value, kalman.position[1].value,
+                        kalman.position[2].value};
+            velocity = {kalman.position[0].rate, kalman.position[1].rate,
+                        kalman.position[2].rate};
+            angularVelocity = {kalman.angularVelocity[0].value, kalman.angularVelocity[1].value,
+                               kalman.angularVelocity[2].value};
+            angularAcceleration = {kalman.angularVelocity[0].rate,
+                                   kalman.angularVelocity[1].rate,
+                                   kalman.angularVelocity[2].rate};
+        }
+
+        const float halfDt2 = 0.5f * dt * dt;
+        pose->pose.position = {position.x + velocity.x * dt + acceleration.x * halfDt2,
+                               position.y + velocity.y * dt + acceleration.y * halfDt2,
+                               position.z + velocity.z * dt + acceleration.z * halfDt2};
+        // Angular velocity is in the base space, so the increment applies on the left.
+        const XrVector3f rotation{angularVelocity.x * dt + angularAcceleration.x * halfDt2,
+                                  angularVelocity.y * dt + angularAcceleration.y * halfDt2,
+                                  angularVelocity.z * dt + angularAcceleration.z * halfDt2};
+        pose->pose.orientation = quaternionMultiply(quaternionFromRotationVector(rotation),
+                                                    pose->pose.orientation);
+        pose->linearVelocity = {velocity.x + acceleration.x * dt,
+                                velocity.y + acceleration.y * dt,
+                                velocity.z + acceleration.z * dt};
+        pose->angularVelocity = {angularVelocity.x + angularAcceleration.x * dt,
+                                 angularVelocity.y + angularAcceleration.y * dt,
+                                 angularVelocity.z + angularAcceleration.z * dt};
+    }
+
+    void PosePredictor::estimateAcceleration(int device, XrVector3f *linear,
+                                             XrVector3f *angular) const {
+        *linear = {0, 0, 0};
+        *angular = {0, 0, 0};
+        const uint32_t count = m_history.size();
+        if (count < 2) return;
+        const PoseSample &newest = m_history.at(count - 1);
+        const DevicePose &b = newest.devices[device];
+        if (!b.valid) return;
+        for (uint32_t i = count - 1; i-- > 0;) {
+            const PoseSample &older = m_history.at(i);
+            const DevicePose &a = older.devices[device];
+            if (!a.valid) return;
+            if (newest.time - older.time < ACCELERATION_WINDOW_NS) continue;
+            const float span = (float) (newest.time - older.time) * 1e-9f;
+            *linear = {(b.linearVelocity.x - a.linearVelocity.x) / span,
+                       (b.linearVelocity.y - a.linearVelocity.y) / span,
+                       (b.linearVelocity.z - a.linearVelocity.z) / span};
+            *angular = {(b.angularVelocity.x - a.angularVelocity.x) / span,
+                        (b.angularVelocity.y - a.angularVelocity.y) / span,
+                        (b.angularVelocity.z - a.angularVelocity.z) / span};
+            return;
+        }
+    }
+
+    std::array<PredictionError, Device::COUNT> PosePredictor::evaluate(
+            PredictionModel model, const PoseSample *trace, size_t count, XrDuration horizon) {
+        std::array<PredictionError, Device::COUNT> errors{};
+        PosePredictor predictor;
+        predictor.setModel(model);
+        // Trace samples up to the first one past the target, to interpolate the truth from.
+        PoseHistory truth;
+        size_t next = 0;
+        for (size_t i = 0; i < count; i++) {
+            predictor.addSample(trace[i]);
+            const XrTime target = trace[i].time + horizon;
+            PoseSample actual;
+            while (next < count && (!truth.latest(&actual) || actual.time < target)) {
+                truth.push(trace[next++]);
+            }
+            if (!truth.latest(&actual) || actual.time < target) break;
+            truth.sample(target, &actual);
+
+            PoseSample predicted;
+            predictor.predict(target, &predicted);
+            for (int device = 0; device < Device::COUNT; device++) {
+                const DevicePose &p = predicted.devices[device];
+                const DevicePose &a = actual.devices[device];
+                if (!p.valid || !a.valid) continue;
+                const float angle = angleBetween(p.pose.orientation, a.pose.orientation);
+                const float dx = p.pose.position.x - a.pose.position.x;
+                const float dy = p.pose.position.y - a.pose.position.y;
+                const float dz = p.pose.position.z - a.pose.position.z;
+                const float distance = sqrtf(dx * dx + dy * dy + dz * dz);
+                PredictionError &error = errors[device];
+                error.count++;
+                error.meanAngle += angle;
+                error.maxAngle = std::max(error.maxAngle, angle);
+                error.meanPosition += distance;
+                error.maxPosition = std::max(error.maxPosition, distance);
+            }
+        }
+        for (PredictionError &error : errors) {
+            if (error.count == 0) continue;
+            error.meanAngle /= (float) error.count;
+            error.meanPosition /= (float) error.count;
+        }
+        return errors;
+    }
+}
@@ -0,0 +1,81 @@
+//
+// Client-side extrapolation of tracked device poses, used when server prediction is disabled.
+//
+
+#ifndef CLOUDXR_POSEPREDICTOR_H
+#define CLOUDXR_POSEPREDICTOR_H
+
+#include <openxr/openxr.h>
+#include <array>
+#include "PoseHistory.h"
+
+namespace ssnwt {
+    // Values match ClientOptions::mPosePredictor.
+    enum class PredictionModel : uint32_t {
+        None = 0,
+        ConstantVelocity = 1,
+        ConstantAcceleration = 2,
+        Kalman = 3,
+        COUNT
+    };
+
+    const char *PredictionModelToString(PredictionModel model);
+
+    struct PredictionError {
+        uint32_t count;
+        float meanAngle;        // radians
+        float maxAngle;
+        float meanPosition;     // meters
+        float maxPosition;
+    };
+
+    class PosePredictor {
+    public:
+        void setModel(PredictionModel model) { m_model = model; }
+
+        PredictionModel getModel() const { return m_model; }
+
+        void reset();
+
+        // Measured poses, a sample not newer than the last one is dropped.
+        void addSample(const PoseSample &sample);
+
+        // Newest sample extrapolated to time with the current model, returns false when empty.
+        bool predict(XrTime time, PoseSample *out) const;
+
+        // Replays measured poses through a fresh predictor, predicting every sample horizon
+        // ahead and comparing with the measurements at that time. PoseTraceEval runs it on
+        // recorded traces.
+        static std::array<PredictionError, Device::COUNT> evaluate(
+                PredictionModel model, const PoseSample *trace, size_t count, XrDuration horizon);
+
+    private:
+        // Two-state filter of one axis: a value and its rate, only the value is measured.
+        struct KalmanAxis {
+            float value;
+            float rate;
+            float p00, p01, p11;
+
+            void reset(float measured, float measurementNoise);
+
+            void update(float measured, float dt, float processNoise, float measurementNoise);
+        };
+
+        // Position with linear velocity, and angular velocity with angular acceleration.
+        struct KalmanDevice {
+            std::array<KalmanAxis, 3> position;
+            std::array<KalmanAxis, 3> angularVelocity;
+            bool valid;
+        };
+
+        void predictDevice(int device, float dt, DevicePose *pose) const;
+
+        void estimateAcceleration(int device, XrVector3f *linear, XrVector3f *angular) const;
+
+        PredictionModel m_model{PredictionModel::None};
+        PoseHistory m_history;
+        std::array<KalmanDevice, Device::COUNT> m_kalman{};
+    };
+}
+
+#endif //CLOUDXR_POSEPREDICTOR_H
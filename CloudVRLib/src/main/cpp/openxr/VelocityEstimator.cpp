@@ -0,0 +1,66 @@
+#include <cmath>
+#include "VelocityEstimator.h"
+#include "PoseMath.h"
+
+namespace ssnwt {
+    // Samples closer together than this are too noisy to difference.
+    constexpr XrTime MIN_SPAN_NS = 500000;
+    // Samples further apart than this describe a motion that is already over.
+    constexpr XrTime MAX_SPAN_NS = 100000000;
+
+    void VelocityEstimator::reset() {
+        m_head = 0;
+        m_count = 0;
+    }
+
+    void VelocityEstimator::update(XrTime time, const XrSpaceLocation &location,
+                                   XrSpaceVelocity *velocity) {
+        const XrSpaceLocationFlags poseValid =
+                XR_SPACE_LOCATION_POSITION_VALID_BIT | XR_SPACE_LOCATION_ORIENTATION_VALID_BIT;
+        if ((location.locationFlags & poseValid) != poseValid) {
+            reset();
+            return;
+        }
+        const Sample &newest = m_samples[(m_head + SAMPLE_COUNT - 1) % SAMPLE_COUNT];
+        if (m_count == 0 || time > newest.time) {
+            m_samples[m_head] = {time, location.pose};
+            m_head = (m_head + 1) % SAMPLE_COUNT;
+            if (m_count < SAMPLE_COUNT) m_count++;
+        }
+
+        const XrSpaceVelocityFlags velocityValid =
+                XR_SPACE_VELOCITY_LINEAR_VALID_BIT | XR_SPACE_VELOCITY_ANGULAR_VALID_BIT;
+        if (velocity == nullptr || (velocity->velocityFlags & velocityValid) == velocityValid) {
+            return;
+        }
+        XrVector3f linear, angular;
+        if (!estimate(&linear, &angular)) return;
+        if ((velocity->velocityFlags & XR_SPACE_VELOCITY_LINEAR_VALID_BIT) == 0) {
+            velocity->linearVelocity = linear;
+            velocity->velocityFlags |= XR_SPACE_VELOCITY_LINEAR_VALID_BIT;
+        }
+        if ((velocity->velocityFlags & XR_SPACE_VELOCITY_ANGULAR_VALID_BIT) == 0) {
+            velocity->angularVelocity = angular;
+            velocity->velocityFlags |= XR_SPACE_VELOCITY_ANGULAR_VALID_BIT;
+        }
+    }
+
+    bool VelocityEstimator::estimate(XrVector3f *linear, XrVector3f *angular) const {
+        if (m_count < 2) return false;
+        const Sample &oldest = m_samples[(m_head + SAMPLE_COUNT - m_count) % SAMPLE_COUNT];
+        const Sample &newest = m_samples[(m_head + SAMPLE_COUNT - 1) % SAMPLE_COUNT];
+        const XrTime span = newest.time - oldest.time;
+        if (span < MIN_SPAN_NS || span > MAX_SPAN_NS) return false;
+        const float dt = (float) span * 1e-9f;
+
+        const XrVector3f &p0 = oldest.pose.position;
+        const XrVector3f &p1 = newest.pose.position;
+        *linear = {(p1.x - p0.x) / dt, (p1.y - p0.y) / dt, (p1.z - p0.z) / dt};
+
+        // The rotation applied in the base space over the span.
+        const XrVector3f rotation = rotationVectorFromQuaternion(quaternionMultiply(
+                newest.pose.orientation, quaternionConjugate(oldest.pose.orientation)));
+        *angular = {rotation.x / dt, rotation.y / dt, rotation.z / dt};
+        return true;
+    }
+}
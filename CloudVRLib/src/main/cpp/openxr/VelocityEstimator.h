@@ -0,0 +1,37 @@
+//
+// Finite-difference velocity for runtimes that leave XrSpaceVelocity empty.
+//
+
+#ifndef CLOUDXR_VELOCITYESTIMATOR_H
+#define CLOUDXR_VELOCITYESTIMATOR_H
+
+#include <openxr/openxr.h>
+#include <array>
+
+namespace ssnwt {
+    class VelocityEstimator {
+    public:
+        // Number of pose samples the estimate spans, oldest to newest.
+        static constexpr uint32_t SAMPLE_COUNT = 4;
+
+        void reset();
+
+        // Record the located pose and fill any velocity the runtime did not report.
+        // Angular velocity is expressed in the base space, like XrSpaceVelocity.
+        void update(XrTime time, const XrSpaceLocation &location, XrSpaceVelocity *velocity);
+
+    private:
+        struct Sample {
+            XrTime time;
+            XrPosef pose;
+        };
+
+        bool estimate(XrVector3f *linear, XrVector3f *angular) const;
+
+        std::array<Sample, SAMPLE_COUNT> m_samples{};
+        uint32_t m_head{0};
+        uint32_t m_count{0};
+    };
+}
+
+#endif //CLOUDXR_VELOCITYESTIMATOR_H
@@ -15,7 +15,12 @@ public class CloudXR {
     private static final String EXTRA_FPS = "fps";
     private static final String EXTRA_IPD = "ipd";
     private static final String EXTRA_PRED_OFFSET = "pred_offset";
+    private static final String EXTRA_LATENCY_PRESET = "latency_preset";
     private static final String CMD_LINE = "-s %s";
+    private static final String CMD_LINE_LATENCY_PRESET = " -lp %s";
+    public static final String LATENCY_PRESET_LOWEST_LATENCY = "lowest-latency";
+    public static final String LATENCY_PRESET_BALANCED = "balanced";
+    public static final String LATENCY_PRESET_SMOOTH = "smooth";
     private static final int DEFAULT_FOV_X = 95;
     private static final int DEFAULT_FOV_Y = 95;
     private static final int DEFAULT_FPS = 72;
@@ -30,6 +35,8 @@ public class CloudXR {
         public int fps = DEFAULT_FPS;
         public float ipd = DEFAULT_IPD;
         public float predOffset = DEFAULT_PRED_OFFSET;
+        // One of LATENCY_PRESET_*, null keeps the SDK's queue depth and VVSync.
+        public String latencyPreset = null;
     }
 
     public static HMDInfo getHmdInfo(Intent intent) {
@@ -45,6 +52,10 @@ public class CloudXR {
         info.fps = intent.getIntExtra(EXTRA_FPS, DEFAULT_FPS);
         info.ipd = intent.getFloatExtra(EXTRA_IPD, DEFAULT_IPD);
         info.predOffset = intent.getFloatExtra(EXTRA_PRED_OFFSET, DEFAULT_PRED_OFFSET);
+        info.latencyPreset = intent.getStringExtra(EXTRA_LATENCY_PRESET);
+        if (!TextUtils.isEmpty(info.latencyPreset)) {
+            info.cmd += String.format(CMD_LINE_LATENCY_PRESET, info.latencyPreset);
+        }
         return info;
     }
 
@@ -54,8 +65,14 @@ public class CloudXR {
 
     public static void startCloudXR(Context context, String ip, int fovX, int fovY,
         int fps, float ipd, float predOffset) {
+        startCloudXR(context, ip, fovX, fovY, fps, ipd, predOffset, null);
+    }
+
+    public static void startCloudXR(Context context, String ip, int fovX, int fovY,
+        int fps, float ipd, float predOffset, String latencyPreset) {
         Intent intent = new Intent(context, CloudVRActivity.class);
         intent.putExtra(EXTRA_IP, ip);
+        if (!TextUtils.isEmpty(latencyPreset)) intent.putExtra(EXTRA_LATENCY_PRESET, latencyPreset);
         if (fovX > 0) intent.putExtra(EXTRA_FOV_X, fovX);
         if (fovX > 0) intent.putExtra(EXTRA_FOV_Y, fovY);
         if (fovX > 0) intent.putExtra(EXTRA_FPS, fps);
@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <new>
+#include <thread>
+#include "AllocationCounter.h"
+
+using namespace ssnwt;
+
+namespace {
+    // Calls operator new directly, a new expression whose result goes unused may be elided.
+    void allocate() {
+        ::operator delete(::operator new(16));
+        ::operator delete[](::operator new[](16));
+    }
+
+    void warmUp(AllocationCounter *counter) {
+        for (int i = 0; i < 120; i++) {
+            counter->frameStart();
+            allocate();
+            counter->frameEnd();
+        }
+    }
+}
+
+TEST(AllocationCounterTest, CountsTheCallingThread) {
+    const uint64_t before = AllocationCounter::getThreadCount();
+    allocate();
+    EXPECT_EQ(before + 2, AllocationCounter::getThreadCount());
+
+    // Starting a thread allocates on this one, only count while the other one allocates.
+    std::atomic<bool> go{false};
+    std::thread other([&go] {
+        while (!go) std::this_thread::yield();
+        allocate();
+    });
+    const uint64_t started = AllocationCounter::getThreadCount();
+    go = true;
+    other.join();
+    EXPECT_EQ(started, AllocationCounter::getThreadCount());
+}
+
+TEST(AllocationCounterTest, QuietFramesPassAfterTheWarmUp) {
+    AllocationCounter counter;
+    warmUp(&counter);
+    for (int i = 0; i < 10; i++) {
+        counter.frameStart();
+        counter.frameEnd();
+    }
+}
+
+TEST(AllocationCounterTest, NoFrameIsCheckedDuringTheWarmUp) {
+    AllocationCounter counter;
+    warmUp(&counter);
+    counter.reset();
+    warmUp(&counter);
+}
+
+TEST(AllocationCounterTest, AbortsOnASteadyStateAllocation) {
+    ::testing::GTEST_FLAG(death_test_style) = "threadsafe";
+    AllocationCounter counter;
+    warmUp(&counter);
+    EXPECT_DEATH({
+        counter.frameStart();
+        allocate();
+        counter.frameEnd();
+    }, "heap allocations in a steady state frame");
+}
@@ -0,0 +1,200 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include "nvidia/ConnectionStateMachine.h"
+
+using namespace ssnwt;
+
+namespace {
+    constexpr int64_t MS = 1000000;
+
+    typedef std::pair<cxrClientState, cxrStateReason> ClientEvent;
+
+    // Stands in for the cxr* receiver: every connect() plays the client states scripted for
+    // that attempt into the machine, the way the SDK thread reports them to CloudXR.
+    class ScriptedReceiver {
+    public:
+        explicit ScriptedReceiver(ConnectionStateMachine *machine) : machine(machine) {}
+
+        void script(std::vector<ClientEvent> events) { attempts.push_back(std::move(events)); }
+
+        // Scripts the same attempt over and over.
+        void scriptRepeated(const std::vector<ClientEvent> &events, int count) {
+            for (int i = 0; i < count; i++) script(events);
+        }
+
+        void connect(int64_t timeNs) {
+            ASSERT_LT(connects, attempts.size()) << "nothing scripted for this attempt";
+            for (const ClientEvent &event : attempts[connects]) {
+                machine->update(event.first, event.second, timeNs);
+            }
+            connects++;
+        }
+
+        size_t getConnects() const { return connects; }
+
+    private:
+        ConnectionStateMachine *machine;
+        std::vector<std::vector<ClientEvent>> attempts;
+        size_t connects = 0;
+    };
+
+    // CloudXR::connect, then CloudXR::reconnect whenever a retry is due, until the machine
+    // stops recovering. Returns the backoff before every retry.
+    std::vector<int64_t> run(ConnectionStateMachine *machine, ScriptedReceiver *receiver,
+                             int64_t timeNs) {
+        std::vector<int64_t> backoffs;
+        machine->start(timeNs);
+        receiver->connect(timeNs);
+        while (machine->getState() == ConnectionState::Recovering) {
+            const int64_t retryTimeNs = machine->getRetryTimeNs();
+            EXPECT_FALSE(machine->isRetryDue(retryTimeNs - 1));
+            EXPECT_TRUE(machine->isRetryDue(retryTimeNs));
+            backoffs.push_back(retryTimeNs - timeNs);
+            timeNs = retryTimeNs;
+            machine->retry();
+            receiver->connect(timeNs);
+        }
+        return backoffs;
+    }
+
+    std::vector<ClientEvent> failedAttempt(cxrStateReason reason) {
+        return {{cxrClientState_ConnectionAttemptInProgress, cxrStateReason_NoError},
+                {cxrClientState_ConnectionAttemptFailed, reason}};
+    }
+
+    const std::vector<ClientEvent> STREAMING = {
+            {cxrClientState_ConnectionAttemptInProgress, cxrStateReason_NoError},
+            {cxrClientState_StreamingSessionInProgress, cxrStateReason_NoError}};
+
+    // Scripts the connect and every retry to fail, returns how many retries there were.
+    size_t countRetries(cxrStateReason reason) {
+        ConnectionStateMachine machine;
+        ScriptedReceiver receiver(&machine);
+        receiver.scriptRepeated(failedAttempt(reason), 20);
+        run(&machine, &receiver, 1000 * MS);
+        EXPECT_EQ(ConnectionState::Failed, machine.getState());
+        return receiver.getConnects() - 1;
+    }
+}
+
+TEST(ConnectionStateMachineTest, ConnectsAndStreams) {
+    ConnectionStateMachine machine;
+    EXPECT_EQ(ConnectionState::Idle, machine.getState());
+    machine.start(0);
+    EXPECT_EQ(ConnectionState::Connecting, machine.getState());
+    EXPECT_FALSE(machine.update(cxrClientState_ConnectionAttemptInProgress,
+                                cxrStateReason_NoError, 1));
+    EXPECT_TRUE(machine.update(cxrClientState_StreamingSessionInProgress,
+                               cxrStateReason_NoError, 2));
+    EXPECT_EQ(ConnectionState::Streaming, machine.getState());
+    EXPECT_FALSE(machine.isRetryDue(INT64_MAX));
+}
+
+TEST(ConnectionStateMachineTest, ExpectedDisconnectAndExitGoIdle) {
+    ConnectionStateMachine machine;
+    ScriptedReceiver receiver(&machine);
+    receiver.script({STREAMING[0], STREAMING[1],
+                     {cxrClientState_Disconnected, cxrStateReason_DisconnectedExpected}});
+    receiver.script({STREAMING[0], STREAMING[1],
+                     {cxrClientState_Exiting, cxrStateReason_NoError}});
+    EXPECT_TRUE(run(&machine, &receiver, 0).empty());
+    EXPECT_EQ(ConnectionState::Idle, machine.getState());
+    EXPECT_TRUE(run(&machine, &receiver, 0).empty());
+    EXPECT_EQ(ConnectionState::Idle, machine.getState());
+}
+
+TEST(ConnectionStateMachineTest, IgnoresTheReceiverAfterStop) {
+    ConnectionStateMachine machine;
+    machine.start(0);
+    machine.stop();
+    EXPECT_FALSE(machine.update(cxrClientState_Disconnected,
+                                cxrStateReason_DisconnectedUnexpected, 1));
+    EXPECT_EQ(ConnectionState::Idle, machine.getState());
+}
+
+TEST(ConnectionStateMachineTest, IgnoresReportsWhileRecovering) {
+    ConnectionStateMachine machine;
+    machine.start(0);
+    EXPECT_TRUE(machine.update(cxrClientState_ConnectionAttemptFailed,
+                               cxrStateReason_NetworkError, 0));
+    EXPECT_EQ(ConnectionState::Recovering, machine.getState());
+    const int64_t retryTimeNs = machine.getRetryTimeNs();
+    // The receiver being torn down still reports, it neither fails nor reschedules the retry.
+    EXPECT_FALSE(machine.update(cxrClientState_ConnectionAttemptFailed,
+                                cxrStateReason_AuthorizationFailed, 1));
+    EXPECT_EQ(ConnectionState::Recovering, machine.getState());
+    EXPECT_EQ(retryTimeNs, machine.getRetryTimeNs());
+}
+
+TEST(ConnectionStateMachineTest, RetryLimitsDependOnTheReason) {
+    EXPECT_EQ(10u, countRetries(cxrStateReason_NetworkError));
+    EXPECT_EQ(10u, countRetries(cxrStateReason_DisconnectedUnexpected));
+    EXPECT_EQ(5u, countRetries(cxrStateReason_RTSPCannotConnect));
+    EXPECT_EQ(5u, countRetries(cxrStateReason_HolePunchFailed));
+    EXPECT_EQ(0u, countRetries(cxrStateReason_HEVCUnsupported));
+    EXPECT_EQ(0u, countRetries(cxrStateReason_VersionMismatch));
+    EXPECT_EQ(0u, countRetries(cxrStateReason_DisabledFeature));
+    EXPECT_EQ(0u, countRetries(cxrStateReason_AuthorizationFailed));
+}
+
+TEST(ConnectionStateMachineTest, DroppedStreamIsRetried) {
+    ConnectionStateMachine machine;
+    ScriptedReceiver receiver(&machine);
+    receiver.script({STREAMING[0], STREAMING[1],
+                     {cxrClientState_Disconnected, cxrStateReason_DisconnectedUnexpected}});
+    receiver.script(STREAMING);
+    const std::vector<int64_t> backoffs = run(&machine, &receiver, 0);
+    ASSERT_EQ(1u, backoffs.size());
+    EXPECT_EQ(250 * MS, backoffs[0]);
+    EXPECT_EQ(ConnectionState::Streaming, machine.getState());
+}
+
+TEST(ConnectionStateMachineTest, StreamingResetsTheRetries) {
+    ConnectionStateMachine machine;
+    ScriptedReceiver receiver(&machine);
+    receiver.scriptRepeated(failedAttempt(cxrStateReason_RTSPCannotConnect), 4);
+    receiver.script({STREAMING[0], STREAMING[1],
+                     {cxrClientState_Disconnected, cxrStateReason_DisconnectedUnexpected}});
+    receiver.scriptRepeated(failedAttempt(cxrStateReason_RTSPCannotConnect), 5);
+    const std::vector<int64_t> backoffs = run(&machine, &receiver, 0);
+    // 4 retries to get streaming, then the drop starts over with a quick first retry and
+    // the full 5 again.
+    ASSERT_EQ(9u, backoffs.size());
+    EXPECT_EQ(250 * MS, backoffs[0]);
+    EXPECT_EQ(250 * MS, backoffs[4]);
+    EXPECT_EQ(ConnectionState::Failed, machine.getState());
+}
+
+TEST(ConnectionStateMachineTest, BackoffIsJitteredAndCapped) {
+    // Every seed, the first retry goes out after 250 ms, the ones after in the upper half of
+    // 500 ms doubling up to 30 s.
+    for (int64_t startNs = 0; startNs < 200; startNs++) {
+        ConnectionStateMachine machine;
+        ScriptedReceiver receiver(&machine);
+        receiver.scriptRepeated(failedAttempt(cxrStateReason_NetworkError), 11);
+        const std::vector<int64_t> backoffs = run(&machine, &receiver, startNs * 7919 * MS);
+        ASSERT_EQ(10u, backoffs.size());
+        EXPECT_EQ(250 * MS, backoffs[0]);
+        int64_t backoffNs = 500 * MS;
+        for (size_t i = 1; i < backoffs.size(); i++) {
+            const int64_t capNs = std::min(backoffNs, (int64_t) 30000 * MS);
+            EXPECT_GE(backoffs[i], capNs / 2) << "retry " << i + 1;
+            EXPECT_LE(backoffs[i], capNs) << "retry " << i + 1;
+            backoffNs *= 2;
+        }
+    }
+}
+
+TEST(ConnectionStateMachineTest, BackoffActuallyJitters) {
+    std::vector<int64_t> seconds;
+    for (int64_t startNs = 0; startNs < 16; startNs++) {
+        ConnectionStateMachine machine;
+        ScriptedReceiver receiver(&machine);
+        receiver.scriptRepeated(failedAttempt(cxrStateReason_NetworkError), 11);
+        seconds.push_back(run(&machine, &receiver, startNs * MS)[1]);
+    }
+    std::sort(seconds.begin(), seconds.end());
+    EXPECT_LT(seconds.front(), seconds.back());
+}
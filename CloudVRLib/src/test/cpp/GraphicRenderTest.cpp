@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include "GraphicRender.h"
+
+using namespace ssnwt;
+
+namespace {
+    // Quest 2 stream size, both eyes side by side.
+    constexpr int32_t WIDTH = 3664;
+    constexpr int32_t HEIGHT = 1920;
+
+    // An ES 3 context without any window, on Mesa that is llvmpipe when there is no GPU.
+    class GraphicRenderTest : public testing::Test {
+    protected:
+        void SetUp() override {
+            auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+                    eglGetProcAddress("eglGetPlatformDisplayEXT"));
+            if (getPlatformDisplay == nullptr) GTEST_SKIP() << "no EGL_EXT_platform_base";
+            display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY,
+                                         nullptr);
+            if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr)) {
+                display = EGL_NO_DISPLAY;
+                GTEST_SKIP() << "no surfaceless EGL display";
+            }
+            eglBindAPI(EGL_OPENGL_ES_API);
+            // eglChooseConfig defaults to window configs, there are none without a window system.
+            const EGLint configAttribs[] = {EGL_RENDERABLE_TYPE, EGL_OPENGL_ES3_BIT_KHR,
+                                            EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_NONE};
+            EGLConfig config;
+            EGLint configCount = 0;
+            if (!eglChooseConfig(display, configAttribs, &config, 1, &configCount) ||
+                configCount == 0) {
+                GTEST_SKIP() << "no ES 3 config";
+            }
+            const EGLint contextAttribs[] = {EGL_CONTEXT_CLIENT_VERSION, 3, EGL_NONE};
+            context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+            if (context == EGL_NO_CONTEXT ||
+                !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+                GTEST_SKIP() << "no surfaceless ES 3 context";
+            }
+        }
+
+        void TearDown() override {
+            if (display == EGL_NO_DISPLAY) return;
+            eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+            if (context != EGL_NO_CONTEXT) eglDestroyContext(display, context);
+            eglTerminate(display);
+        }
+
+        EGLDisplay display = EGL_NO_DISPLAY;
+        EGLContext context = EGL_NO_CONTEXT;
+    };
+}
+
+TEST_F(GraphicRenderTest, EyeFramebuffersAreComplete) {
+    // Value initialized like main's new GraphicRender(), initialize() checks the size.
+    GraphicRender render{};
+    render.initialize(WIDTH, HEIGHT);
+    for (int32_t eye = 0; eye < 2; eye++) {
+        ASSERT_TRUE(render.setupFrameBuffer(eye));
+        GLint framebuffer = 0;
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &framebuffer);
+        // createFrameBuffer leaves 0 for an incomplete one.
+        EXPECT_NE(0, framebuffer) << "eye " << eye;
+        EXPECT_EQ((GLenum) GL_FRAMEBUFFER_COMPLETE,
+                  glCheckFramebufferStatus(GL_DRAW_FRAMEBUFFER)) << "eye " << eye;
+        GLint redBits = 0;
+        glGetFramebufferAttachmentParameteriv(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                                              GL_FRAMEBUFFER_ATTACHMENT_RED_SIZE, &redBits);
+        EXPECT_EQ(8, redBits);
+        GraphicRender::bindDefaultFrameBuffer();
+    }
+    // Storage, attachment and the invalidate in setupFrameBuffer were all accepted.
+    EXPECT_EQ((GLenum) GL_NO_ERROR, glGetError());
+    render.release();
+}
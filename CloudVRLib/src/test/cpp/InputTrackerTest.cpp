@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+#include "InputTracker.h"
+
+using namespace ssnwt;
+
+TEST(InputTrackerTest, DebouncesButtonFlips) {
+    ButtonTracker tracker;
+    tracker.setDebounce(2);
+    EXPECT_EQ(0u, tracker.update(0x1));
+    EXPECT_EQ(0x1u, tracker.update(0x1));
+    EXPECT_EQ(0x1u, tracker.getPressed());
+    // A one sample glitch never flips.
+    EXPECT_EQ(0x1u, tracker.update(0x0));
+    EXPECT_EQ(0x1u, tracker.update(0x1));
+    EXPECT_EQ(0u, tracker.getReleased());
+}
+
+TEST(InputTrackerTest, FirstSampleIsAlwaysNew) {
+    ControllerSampleState sampled;
+    cxrControllerTrackingState controller{};
+    EXPECT_TRUE(sampled.hasChanged(controller));
+    sampled.update(controller);
+    EXPECT_FALSE(sampled.hasChanged(controller));
+}
+
+TEST(InputTrackerTest, AnalogChangesAreNew) {
+    ControllerSampleState sampled;
+    cxrControllerTrackingState controller{};
+    sampled.update(controller);
+    controller.scalarComps[cxrAnalog_Trigger] = 0.5f;
+    EXPECT_TRUE(sampled.hasChanged(controller));
+    sampled.update(controller);
+    EXPECT_FALSE(sampled.hasChanged(controller));
+
+    sampled.reset();
+    EXPECT_TRUE(sampled.hasChanged(controller));
+}
+
+TEST(InputTrackerTest, EdgesAreRelativeToTheLastPacket) {
+    PacketEdges edges;
+    cxrVRTrackingState state{};
+    state.controller[0].booleanComps = 0x3;
+    state.controller[1].booleanComps = 0x4;
+    ASSERT_TRUE(edges.claim(1, &state));
+    EXPECT_EQ(0x3u, state.controller[0].booleanCompsChanged);
+    EXPECT_EQ(0x4u, state.controller[1].booleanCompsChanged);
+
+    // The same snapshot polled again tells nothing new.
+    ASSERT_TRUE(edges.claim(1, &state));
+    EXPECT_EQ(0u, state.controller[0].booleanCompsChanged);
+    EXPECT_EQ(0u, state.controller[1].booleanCompsChanged);
+
+    // Versions 2 and 3 were never sent, their edges end up in 4.
+    state.controller[0].booleanComps = 0x1;
+    state.controller[1].booleanComps = 0x4;
+    ASSERT_TRUE(edges.claim(4, &state));
+    EXPECT_EQ(0x2u, state.controller[0].booleanCompsChanged);
+    EXPECT_EQ(0u, state.controller[1].booleanCompsChanged);
+}
+
+TEST(InputTrackerTest, OlderSnapshotsAreNotSentAfterNewerOnes) {
+    PacketEdges edges;
+    cxrVRTrackingState older{};
+    cxrVRTrackingState newer{};
+    newer.controller[0].booleanComps = 0x1;
+    // The poll thread loaded 1, the XR thread pushed 2 before it could send.
+    ASSERT_TRUE(edges.claim(2, &newer));
+    EXPECT_FALSE(edges.claim(1, &older));
+    // It loads again and gets 2, without a release edge.
+    cxrVRTrackingState reloaded = newer;
+    ASSERT_TRUE(edges.claim(2, &reloaded));
+    EXPECT_EQ(0u, reloaded.controller[0].booleanCompsChanged);
+
+    edges.reset();
+    ASSERT_TRUE(edges.claim(1, &older));
+}
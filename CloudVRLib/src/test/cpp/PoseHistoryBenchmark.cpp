@@ -0,0 +1,74 @@
+//
+// Times PoseHistory::push into a full ring and PoseHistory::sample between two entries, the
+// binary search plus the slerp/lerp of every device. Not a test, run it by hand on a quiet
+// machine, on the target, when changing the history or its capacity.
+//
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include "PoseHistory.h"
+#include "PoseMath.h"
+
+using namespace ssnwt;
+
+namespace {
+    constexpr int ITERATIONS = 2000000;
+    constexpr XrDuration PERIOD_NS = 8333333;      // 120 Hz
+
+    // Keeps the compiler from dropping the calls.
+    volatile float sink;
+
+    template<typename Call>
+    double nsPerCall(Call call) {
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < ITERATIONS; i++) call(i);
+        const std::chrono::duration<double, std::nano> elapsed =
+                std::chrono::steady_clock::now() - start;
+        return elapsed.count() / ITERATIONS;
+    }
+
+    PoseSample randomSample(std::mt19937 &random, XrTime time) {
+        std::uniform_real_distribution<float> unit(-1.f, 1.f);
+        PoseSample sample{};
+        sample.time = time;
+        for (DevicePose &device : sample.devices) {
+            const XrVector3f v{unit(random), unit(random), unit(random)};
+            device = {{quaternionFromRotationVector(v), v}, v, v, true};
+        }
+        return sample;
+    }
+}
+
+int main() {
+    std::mt19937 random(1);
+    PoseHistory history;
+    XrTime time = 1000000000;
+    for (uint32_t i = 0; i < PoseHistory::CAPACITY; i++, time += PERIOD_NS) {
+        history.push(randomSample(random, time));
+    }
+
+    // Overwrites the oldest entry every call, like the pose poll once the ring is full.
+    PoseSample sample = randomSample(random, time);
+    printf("push: %.1f ns\n", nsPerCall([&](int i) {
+        sample.time = time + (XrTime) i * PERIOD_NS;
+        history.push(sample);
+        sink = history.at(history.size() - 1).devices[Device::HMD].pose.position.x;
+    }));
+
+    // Halfway between entries, at the newest end where the stream samples and spread over
+    // the whole ring.
+    const XrTime newest = history.at(history.size() - 1).time;
+    const XrTime oldest = history.at(0).time;
+    PoseSample out;
+    printf("sample, newest: %.1f ns\n", nsPerCall([&](int i) {
+        history.sample(newest - PERIOD_NS / 2 - (i & 1), &out);
+        sink = out.devices[Device::HMD].pose.orientation.w;
+    }));
+    printf("sample, anywhere: %.1f ns\n", nsPerCall([&](int i) {
+        history.sample(oldest + PERIOD_NS / 2 + (XrTime) (i % PoseHistory::CAPACITY) *
+                (newest - oldest) / PoseHistory::CAPACITY, &out);
+        sink = out.devices[Device::HMD].pose.orientation.w;
+    }));
+    return 0;
+}
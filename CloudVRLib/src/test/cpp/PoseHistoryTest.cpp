@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+#include "PoseHistory.h"
+#include "PoseMath.h"
+
+using namespace ssnwt;
+
+namespace {
+    // HMD at (x, 0, 0) turned yaw radians, both hands untracked.
+    PoseSample makeSample(XrTime time, float x, float yaw) {
+        PoseSample sample{};
+        sample.time = time;
+        DevicePose &hmd = sample.devices[Device::HMD];
+        hmd.pose = {quaternionFromYaw(yaw), {x, 0, 0}};
+        hmd.linearVelocity = {x, 0, 0};
+        hmd.angularVelocity = {0, yaw, 0};
+        hmd.valid = true;
+        return sample;
+    }
+
+    float yawOf(const XrQuaternionf &q) {
+        return angleBetween(q, {0, 0, 0, 1});
+    }
+}
+
+TEST(PoseHistoryTest, EmptyHistoryHasNoSample) {
+    PoseHistory history;
+    PoseSample out{};
+    EXPECT_FALSE(history.sample(0, &out));
+    EXPECT_FALSE(history.latest(&out));
+    EXPECT_EQ(0u, history.size());
+}
+
+TEST(PoseHistoryTest, DropsSamplesThatAreNotNewer) {
+    PoseHistory history;
+    history.push(makeSample(100, 1, 0));
+    history.push(makeSample(100, 2, 0));
+    history.push(makeSample(50, 3, 0));
+    ASSERT_EQ(1u, history.size());
+    EXPECT_FLOAT_EQ(1, history.at(0).devices[Device::HMD].pose.position.x);
+}
+
+TEST(PoseHistoryTest, WrapsAroundKeepingTheNewest) {
+    PoseHistory history;
+    const uint32_t pushed = PoseHistory::CAPACITY * 2 + 10;
+    for (uint32_t i = 1; i <= pushed; i++) {
+        history.push(makeSample(i * 10, (float) i, 0));
+    }
+    ASSERT_EQ(PoseHistory::CAPACITY, history.size());
+    const XrTime oldest = (pushed - PoseHistory::CAPACITY + 1) * 10;
+    for (uint32_t i = 0; i < history.size(); i++) {
+        EXPECT_EQ(oldest + i * 10, history.at(i).time);
+    }
+    PoseSample latest{};
+    ASSERT_TRUE(history.latest(&latest));
+    EXPECT_EQ((XrTime) pushed * 10, latest.time);
+
+    history.clear();
+    EXPECT_EQ(0u, history.size());
+    history.push(makeSample(5, 1, 0));
+    EXPECT_EQ(5, history.at(0).time);
+}
+
+TEST(PoseHistoryTest, ClampsBeforeTheOldestSample) {
+    PoseHistory history;
+    history.push(makeSample(100, 1, 0.1f));
+    history.push(makeSample(200, 2, 0.2f));
+    PoseSample out{};
+    ASSERT_TRUE(history.sample(50, &out));
+    EXPECT_EQ(100, out.time);
+    EXPECT_FLOAT_EQ(1, out.devices[Device::HMD].pose.position.x);
+    ASSERT_TRUE(history.sample(100, &out));
+    EXPECT_FLOAT_EQ(1, out.devices[Device::HMD].pose.position.x);
+}
+
+TEST(PoseHistoryTest, ClampsAfterTheNewestSample) {
+    PoseHistory history;
+    history.push(makeSample(100, 1, 0.1f));
+    history.push(makeSample(200, 2, 0.2f));
+    PoseSample out{};
+    ASSERT_TRUE(history.sample(1000, &out));
+    EXPECT_EQ(200, out.time);
+    EXPECT_FLOAT_EQ(2, out.devices[Device::HMD].pose.position.x);
+    ASSERT_TRUE(history.sample(200, &out));
+    EXPECT_FLOAT_EQ(2, out.devices[Device::HMD].pose.position.x);
+}
+
+TEST(PoseHistoryTest, SingleSampleIsReturnedForAnyTime) {
+    PoseHistory history;
+    history.push(makeSample(100, 4, 0));
+    PoseSample out{};
+    ASSERT_TRUE(history.sample(150, &out));
+    EXPECT_FLOAT_EQ(4, out.devices[Device::HMD].pose.position.x);
+}
+
+TEST(PoseHistoryTest, BinarySearchBracketsEveryQuery) {
+    PoseHistory history;
+    // Wrapped, so the bracket has to go through the ring indexing. x == time / 10.
+    const uint32_t pushed = PoseHistory::CAPACITY + 37;
+    for (uint32_t i = 1; i <= pushed; i++) {
+        history.push(makeSample(i * 10, (float) i, 0));
+    }
+    const XrTime oldest = history.at(0).time;
+    const XrTime newest = history.at(history.size() - 1).time;
+    for (XrTime time = oldest; time <= newest; time += 3) {
+        PoseSample out{};
+        ASSERT_TRUE(history.sample(time, &out));
+        EXPECT_NEAR((float) time / 10, out.devices[Device::HMD].pose.position.x, 1e-3f)
+                            << "at " << time;
+    }
+}
+
+TEST(PoseHistoryTest, InterpolatesPositionAndVelocityLinearly) {
+    PoseHistory history;
+    history.push(makeSample(100, 1, 0));
+    history.push(makeSample(200, 3, 0));
+    PoseSample out{};
+    ASSERT_TRUE(history.sample(125, &out));
+    EXPECT_EQ(125, out.time);
+    const DevicePose &hmd = out.devices[Device::HMD];
+    EXPECT_TRUE(hmd.valid);
+    EXPECT_FLOAT_EQ(1.5f, hmd.pose.position.x);
+    EXPECT_FLOAT_EQ(1.5f, hmd.linearVelocity.x);
+}
+
+TEST(PoseHistoryTest, InterpolatesOrientationSpherically) {
+    PoseHistory history;
+    history.push(makeSample(100, 0, 0));
+    history.push(makeSample(200, 0, 1.2f));
+    PoseSample out{};
+    for (float t : {0.25f, 0.5f, 0.75f}) {
+        ASSERT_TRUE(history.sample(100 + (XrTime) (t * 100), &out));
+        const XrQuaternionf &q = out.devices[Device::HMD].pose.orientation;
+        // Constant angular speed along the arc, and still a unit quaternion.
+        EXPECT_NEAR(1.2f * t, yawOf(q), 1e-4f);
+        EXPECT_NEAR(1, q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w, 1e-5f);
+    }
+}
+
+TEST(PoseHistoryTest, SlerpTakesTheShortWay) {
+    PoseHistory history;
+    PoseSample a = makeSample(100, 0, 0.2f);
+    PoseSample b = makeSample(200, 0, 0.4f);
+    // Same orientation as b, from the other hemisphere.
+    XrQuaternionf &q = b.devices[Device::HMD].pose.orientation;
+    q = {-q.x, -q.y, -q.z, -q.w};
+    history.push(a);
+    history.push(b);
+    PoseSample out{};
+    ASSERT_TRUE(history.sample(150, &out));
+    EXPECT_NEAR(0.3f, yawOf(out.devices[Device::HMD].pose.orientation), 1e-4f);
+}
+
+TEST(PoseHistoryTest, NeverBlendsWithAnUntrackedPose) {
+    PoseHistory history;
+    PoseSample a = makeSample(100, 1, 0);
+    PoseSample b = makeSample(200, 2, 0);
+    b.devices[Device::HMD].valid = false;
+    history.push(a);
+    history.push(b);
+    PoseSample out{};
+    ASSERT_TRUE(history.sample(190, &out));
+    EXPECT_TRUE(out.devices[Device::HMD].valid);
+    EXPECT_FLOAT_EQ(1, out.devices[Device::HMD].pose.position.x);
+    // Untracked on both sides stays untracked.
+    EXPECT_FALSE(out.devices[Device::LEFT_HAND].valid);
+}
@@ -0,0 +1,62 @@
+//
+// Times the opt-in POSE_MATH_SIMD path of posesToMatrix34 against the scalar loop, for the
+// HMD plus both controllers and for a larger batch. Not a test, run it by hand on a quiet
+// machine, on the target, before turning POSE_MATH_SIMD on for it.
+//
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include "PoseMath.h"
+
+using namespace ssnwt;
+
+namespace {
+    constexpr int ITERATIONS = 2000000;
+    constexpr size_t MAX_COUNT = 9;
+
+    // Keeps the compiler from dropping the conversions.
+    volatile float sink;
+
+    template<typename Convert>
+    double nsPerCall(const XrPosef *poses, cxrMatrix34 *const *out, size_t count,
+                     Convert convert) {
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < ITERATIONS; i++) {
+            convert(poses, out, count);
+            sink = out[count - 1]->m[2][2];
+        }
+        const std::chrono::duration<double, std::nano> elapsed =
+                std::chrono::steady_clock::now() - start;
+        return elapsed.count() / ITERATIONS;
+    }
+}
+
+int main() {
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> unit(-1.f, 1.f);
+    XrPosef poses[MAX_COUNT];
+    cxrMatrix34 matrices[MAX_COUNT];
+    cxrMatrix34 *out[MAX_COUNT];
+    for (size_t i = 0; i < MAX_COUNT; i++) {
+        const XrVector3f v{unit(random), unit(random), unit(random)};
+        poses[i] = {quaternionFromRotationVector(v), v};
+        out[i] = &matrices[i];
+    }
+    const auto scalar = [](const XrPosef *p, cxrMatrix34 *const *o, size_t count) {
+        for (size_t i = 0; i < count; i++) *o[i] = poseToMatrix34(p[i]);
+    };
+#if defined(POSE_MATH_SSE)
+    const char *path = "sse";
+#elif defined(POSE_MATH_NEON)
+    const char *path = "neon";
+#else
+    const char *path = "scalar";
+#endif
+    for (size_t count : {(size_t) 3, MAX_COUNT}) {
+        printf("%zu poses: scalar %.1f ns, posesToMatrix34 (%s) %.1f ns\n", count,
+               nsPerCall(poses, out, count, scalar), path,
+               nsPerCall(poses, out, count, posesToMatrix34));
+    }
+    return 0;
+}
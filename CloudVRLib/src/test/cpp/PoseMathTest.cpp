@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <random>
+#include "PoseMath.h"
+
+using namespace ssnwt;
+
+TEST(PoseMathTest, RotationVectorRoundTrips) {
+    const XrVector3f vectors[] = {{0, 0, 0}, {1e-7f, 0, 0}, {0.3f, -0.2f, 0.1f},
+                                  {0, 3.0f, 0}, {-1.f, 1.f, 2.f}};
+    for (const XrVector3f &v : vectors) {
+        const XrVector3f r = rotationVectorFromQuaternion(quaternionFromRotationVector(v));
+        EXPECT_NEAR(v.x, r.x, 1e-5f);
+        EXPECT_NEAR(v.y, r.y, 1e-5f);
+        EXPECT_NEAR(v.z, r.z, 1e-5f);
+    }
+}
+
+TEST(PoseMathTest, RotationVectorTakesTheShortWay) {
+    const XrQuaternionf q = quaternionFromRotationVector({0, 0.5f, 0});
+    const XrVector3f r = rotationVectorFromQuaternion({-q.x, -q.y, -q.z, -q.w});
+    EXPECT_NEAR(0.5f, r.y, 1e-5f);
+}
+
+namespace {
+    // Symmetric fov of a stream eye, as OpenXR reports it and as cxrDeviceDesc::proj has it.
+    constexpr float TAN_X = 1.f, TAN_Y = 0.8f;
+    const XrFovf FOV{atanf(-TAN_X), atanf(TAN_X), atanf(TAN_Y), atanf(-TAN_Y)};
+    const float STREAM_PROJ[4] = {-TAN_X, TAN_X, -TAN_Y, TAN_Y};
+
+    // The vertex shader's uWarp * vec3(uv, 1.0), warp being column-major.
+    XrVector3f applyWarp(const float warp[9], float u, float v) {
+        return {warp[0] * u + warp[3] * v + warp[6],
+                warp[1] * u + warp[4] * v + warp[7],
+                warp[2] * u + warp[5] * v + warp[8]};
+    }
+}
+
+TEST(PoseMathTest, UnchangedOrientationGivesIdentityWarp) {
+    const XrQuaternionf orientation = quaternionFromRotationVector({0.2f, -0.4f, 0.1f});
+    float warp[9];
+    reprojectionWarp(orientation, orientation, FOV, STREAM_PROJ, warp);
+    const float identity[9] = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+    for (int i = 0; i < 9; i++) EXPECT_NEAR(identity[i], warp[i], 1e-5f) << "element " << i;
+}
+
+TEST(PoseMathTest, YawLeftSamplesLeftOfTheStream) {
+    // The head turned left since the frame was rendered: the middle of the display shows
+    // what was left of the middle of the stream image.
+    const XrQuaternionf rendered{0, 0, 0, 1};
+    const XrQuaternionf displayed = quaternionFromRotationVector({0, 0.05f, 0});
+    float warp[9];
+    reprojectionWarp(rendered, displayed, FOV, STREAM_PROJ, warp);
+    const XrVector3f uv = applyWarp(warp, 0.5f, 0.5f);
+    ASSERT_GT(uv.z, 0.f);
+    // tan(0.05) of the 2 * TAN_X wide image.
+    EXPECT_NEAR(0.5f - tanf(0.05f) / (2 * TAN_X), uv.x / uv.z, 1e-4f);
+    EXPECT_NEAR(0.5f, uv.y / uv.z, 1e-4f);
+
+    reprojectionWarp(rendered, quaternionConjugate(displayed), FOV, STREAM_PROJ, warp);
+    const XrVector3f right = applyWarp(warp, 0.5f, 0.5f);
+    EXPECT_GT(right.x / right.z, 0.5f);
+}
+
+TEST(PoseMathTest, PointsBehindTheRenderedEyeHaveNoPositiveDepth) {
+    const XrQuaternionf rendered{0, 0, 0, 1};
+    const XrQuaternionf turnedAround = quaternionFromRotationVector({0, 3.14159265f, 0});
+    float warp[9];
+    reprojectionWarp(rendered, turnedAround, FOV, STREAM_PROJ, warp);
+    // The fragment shader discards these instead of dividing by them.
+    for (float u : {0.f, 0.5f, 1.f}) {
+        for (float v : {0.f, 0.5f, 1.f}) {
+            EXPECT_LE(applyWarp(warp, u, v).z, 0.f) << "uv " << u << ", " << v;
+        }
+    }
+}
+
+namespace {
+    XrPosef randomPose(std::mt19937 &random) {
+        std::uniform_real_distribution<float> unit(-1.f, 1.f);
+        XrQuaternionf q{unit(random), unit(random), unit(random), unit(random)};
+        const float len = sqrtf(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+        q = {q.x / len, q.y / len, q.z / len, q.w / len};
+        return {q, {unit(random) * 2, unit(random) * 2, unit(random) * 2}};
+    }
+}
+
+// Built with POSE_MATH_SIMD, posesToMatrix34 takes the SSE path on x86 (NEON on device) four
+// poses at a time. Every count up to 9 covers one, two and three passes with every number of
+// remainder lanes.
+TEST(PoseMathTest, VectorPathMatchesScalarReference) {
+#if !defined(POSE_MATH_SSE) && !defined(POSE_MATH_NEON)
+    GTEST_SKIP() << "no vector path on this target";
+#endif
+    std::mt19937 random(7);
+    for (size_t count = 1; count <= 9; count++) {
+        XrPosef poses[9];
+        cxrMatrix34 matrices[10];
+        cxrMatrix34 *out[9];
+        for (size_t i = 0; i < count; i++) {
+            poses[i] = randomPose(random);
+            out[i] = &matrices[i];
+        }
+        // Lanes past count must not be stored anywhere.
+        memset(matrices, 0x7f, sizeof(matrices));
+        posesToMatrix34(poses, out, count);
+        for (size_t i = 0; i < count; i++) {
+            const cxrMatrix34 expected = poseToMatrix34(poses[i]);
+            for (int r = 0; r < 3; r++) {
+                for (int c = 0; c < 4; c++) {
+                    EXPECT_NEAR(expected.m[r][c], matrices[i].m[r][c], 1e-6f)
+                                        << "count " << count << " pose " << i
+                                        << " [" << r << "][" << c << "]";
+                }
+            }
+        }
+        const cxrMatrix34 &untouched = matrices[count];
+        uint32_t bits;
+        memcpy(&bits, &untouched.m[0][0], sizeof(bits));
+        EXPECT_EQ(0x7f7f7f7fu, bits);
+    }
+}
+
+TEST(PoseMathTest, OutputsMayBeScattered) {
+    std::mt19937 random(11);
+    XrPosef poses[3] = {randomPose(random), randomPose(random), randomPose(random)};
+    cxrMatrix34 a{}, b{}, c{};
+    cxrMatrix34 *out[3] = {&c, &a, &b};
+    posesToMatrix34(poses, out, 3);
+    EXPECT_FLOAT_EQ(poses[0].position.x, c.m[0][3]);
+    EXPECT_FLOAT_EQ(poses[1].position.y, a.m[1][3]);
+    EXPECT_FLOAT_EQ(poses[2].position.z, b.m[2][3]);
+}
@@ -0,0 +1,176 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "PosePredictor.h"
+#include "PoseMath.h"
+
+using namespace ssnwt;
+
+namespace {
+    constexpr XrDuration PERIOD_NS = 11111111;     // 90 Hz
+    constexpr XrDuration HORIZON_NS = 50000000;
+    constexpr float YAW_RATE = 1.f;                 // rad/s
+    constexpr float SPEED = 0.5f;                   // m/s along x
+    constexpr float ACCELERATION = 2.f;             // m/s^2 along x
+    constexpr float ANGULAR_ACCELERATION = 4.f;     // rad/s^2 around y
+
+    // The HMD turning and moving at constant rates, measured at 90 Hz for two seconds.
+    std::vector<PoseSample> makeConstantMotion() {
+        std::vector<PoseSample> trace(180);
+        for (size_t i = 0; i < trace.size(); i++) {
+            const float t = (float) i * (float) PERIOD_NS * 1e-9f;
+            PoseSample &sample = trace[i];
+            sample = {};
+            sample.time = 1000000000 + (XrTime) i * PERIOD_NS;
+            DevicePose &hmd = sample.devices[Device::HMD];
+            hmd.pose = {quaternionFromYaw(YAW_RATE * t), {SPEED * t, 1.6f, 0}};
+            hmd.linearVelocity = {SPEED, 0, 0};
+            hmd.angularVelocity = {0, YAW_RATE, 0};
+            hmd.valid = true;
+        }
+        return trace;
+    }
+
+    // The HMD speeding up from rest, linearly and around the vertical axis.
+    std::vector<PoseSample> makeConstantAcceleration() {
+        std::vector<PoseSample> trace = makeConstantMotion();
+        for (size_t i = 0; i < trace.size(); i++) {
+            const float t = (float) i * (float) PERIOD_NS * 1e-9f;
+            DevicePose &hmd = trace[i].devices[Device::HMD];
+            hmd.pose = {quaternionFromYaw(0.5f * ANGULAR_ACCELERATION * t * t),
+                        {0.5f * ACCELERATION * t * t, 1.6f, 0}};
+            hmd.linearVelocity = {ACCELERATION * t, 0, 0};
+            hmd.angularVelocity = {0, ANGULAR_ACCELERATION * t, 0};
+        }
+        return trace;
+    }
+
+    // Constant motion as a real tracker reports it, with a fixed seed.
+    std::vector<PoseSample> makeNoisyConstantMotion() {
+        std::vector<PoseSample> trace = makeConstantMotion();
+        std::mt19937 random(42);
+        std::normal_distribution<float> positionNoise(0.f, 1e-3f);
+        std::normal_distribution<float> angularNoise(0.f, 0.05f);
+        for (PoseSample &sample : trace) {
+            DevicePose &hmd = sample.devices[Device::HMD];
+            hmd.pose.position.x += positionNoise(random);
+            hmd.pose.position.y += positionNoise(random);
+            hmd.pose.position.z += positionNoise(random);
+            hmd.angularVelocity.x += angularNoise(random);
+            hmd.angularVelocity.y += angularNoise(random);
+            hmd.angularVelocity.z += angularNoise(random);
+        }
+        return trace;
+    }
+
+    // Feeds the trace up to and including last, then predicts HORIZON_NS past it.
+    DevicePose predictAfter(PredictionModel model, const std::vector<PoseSample> &trace,
+                            size_t last) {
+        PosePredictor predictor;
+        predictor.setModel(model);
+        for (size_t i = 0; i <= last; i++) predictor.addSample(trace[i]);
+        PoseSample predicted;
+        EXPECT_TRUE(predictor.predict(trace[last].time + HORIZON_NS, &predicted));
+        return predicted.devices[Device::HMD];
+    }
+}
+
+TEST(PosePredictorTest, WithoutAModelTheErrorIsTheMotionOverTheHorizon) {
+    const std::vector<PoseSample> trace = makeConstantMotion();
+    const auto errors = PosePredictor::evaluate(PredictionModel::None, trace.data(),
+                                                trace.size(), HORIZON_NS);
+    const PredictionError &hmd = errors[Device::HMD];
+    ASSERT_GT(hmd.count, 0u);
+    EXPECT_NEAR(YAW_RATE * HORIZON_NS * 1e-9f, hmd.meanAngle, 1e-3f);
+    EXPECT_NEAR(SPEED * HORIZON_NS * 1e-9f, hmd.meanPosition, 1e-4f);
+    // Untracked hands are not counted.
+    EXPECT_EQ(0u, errors[Device::LEFT_HAND].count);
+}
+
+TEST(PosePredictorTest, ConstantVelocityFollowsConstantMotion) {
+    const std::vector<PoseSample> trace = makeConstantMotion();
+    for (PredictionModel model : {PredictionModel::ConstantVelocity,
+                                  PredictionModel::ConstantAcceleration}) {
+        const auto errors = PosePredictor::evaluate(model, trace.data(), trace.size(),
+                                                    HORIZON_NS);
+        const PredictionError &hmd = errors[Device::HMD];
+        ASSERT_GT(hmd.count, 0u) << PredictionModelToString(model);
+        EXPECT_LT(hmd.maxAngle, 1e-3f) << PredictionModelToString(model);
+        EXPECT_LT(hmd.maxPosition, 1e-4f) << PredictionModelToString(model);
+    }
+}
+
+TEST(PosePredictorTest, EvaluationStopsWhereTheTraceEnds) {
+    const std::vector<PoseSample> trace = makeConstantMotion();
+    const auto errors = PosePredictor::evaluate(PredictionModel::None, trace.data(),
+                                                trace.size(), HORIZON_NS);
+    // Only samples with a measurement at least HORIZON_NS later are scored.
+    const size_t scored = trace.size() - (HORIZON_NS + PERIOD_NS - 1) / PERIOD_NS;
+    EXPECT_EQ(scored, errors[Device::HMD].count);
+}
+
+TEST(PosePredictorTest, ConstantAccelerationFollowsConstantAcceleration) {
+    const std::vector<PoseSample> trace = makeConstantAcceleration();
+    const auto velocity = PosePredictor::evaluate(PredictionModel::ConstantVelocity,
+                                                  trace.data(), trace.size(), HORIZON_NS);
+    const auto acceleration = PosePredictor::evaluate(PredictionModel::ConstantAcceleration,
+                                                      trace.data(), trace.size(), HORIZON_NS);
+    const PredictionError &hmd = acceleration[Device::HMD];
+    ASSERT_GT(hmd.count, 0u);
+    // Constant velocity lags by half the acceleration over the horizon squared.
+    const float h = HORIZON_NS * 1e-9f;
+    EXPECT_NEAR(0.5f * ACCELERATION * h * h, velocity[Device::HMD].maxPosition, 1e-4f);
+    EXPECT_NEAR(0.5f * ANGULAR_ACCELERATION * h * h, velocity[Device::HMD].maxAngle, 1e-3f);
+    // Only the first sample has no earlier velocity to difference with. Whatever is left is
+    // the linear interpolation of the measured truth between samples.
+    EXPECT_LT(hmd.meanPosition, 1e-4f);
+    EXPECT_LT(hmd.meanAngle, 1e-3f);
+    EXPECT_LT(hmd.meanPosition * 10, velocity[Device::HMD].meanPosition);
+}
+
+TEST(PosePredictorTest, KalmanConvergesOnConstantMotion) {
+    const std::vector<PoseSample> trace = makeConstantMotion();
+    const float h = HORIZON_NS * 1e-9f;
+    // Only positions are measured, the first prediction has no velocity yet.
+    const DevicePose first = predictAfter(PredictionModel::Kalman, trace, 0);
+    EXPECT_NEAR(0.f, first.pose.position.x, 1e-5f);
+    // A second of samples later the velocity is known.
+    const size_t last = 90;
+    const float t = (float) last * (float) PERIOD_NS * 1e-9f + h;
+    const DevicePose settled = predictAfter(PredictionModel::Kalman, trace, last);
+    EXPECT_NEAR(SPEED * t, settled.pose.position.x, 1e-4f);
+    EXPECT_NEAR(SPEED, settled.linearVelocity.x, 1e-3f);
+    EXPECT_NEAR(YAW_RATE, settled.angularVelocity.y, 1e-3f);
+    EXPECT_LT(angleBetween(quaternionFromYaw(YAW_RATE * t), settled.pose.orientation),
+              1e-3f);
+}
+
+TEST(PosePredictorTest, KalmanStaysBoundedOnNoisyInput) {
+    const std::vector<PoseSample> trace = makeNoisyConstantMotion();
+    const float h = HORIZON_NS * 1e-9f;
+    PosePredictor predictor;
+    predictor.setModel(PredictionModel::Kalman);
+    // Mean errors against the noise free motion, over the first and the second second.
+    float position[2] = {0, 0};
+    float angle[2] = {0, 0};
+    const size_t half = trace.size() / 2;
+    for (size_t i = 0; i < trace.size(); i++) {
+        predictor.addSample(trace[i]);
+        PoseSample predicted;
+        ASSERT_TRUE(predictor.predict(trace[i].time + HORIZON_NS, &predicted));
+        const XrPosef &pose = predicted.devices[Device::HMD].pose;
+        const float t = (float) i * (float) PERIOD_NS * 1e-9f + h;
+        const XrVector3f d{pose.position.x - SPEED * t, pose.position.y - 1.6f, pose.position.z};
+        position[i / half] += sqrtf(d.x * d.x + d.y * d.y + d.z * d.z) / (float) half;
+        angle[i / half] += angleBetween(quaternionFromYaw(YAW_RATE * t), pose.orientation) /
+                           (float) half;
+    }
+    ASSERT_TRUE(std::isfinite(position[1]) && std::isfinite(angle[1]));
+    // The noise does not build up over time.
+    EXPECT_LT(position[1], position[0] * 1.5f);
+    EXPECT_LT(angle[1], angle[0] * 1.5f);
+    // And the prediction still beats none at all.
+    EXPECT_LT(position[1], SPEED * h / 2);
+    EXPECT_LT(angle[1], YAW_RATE * h / 2);
+}
@@ -0,0 +1,53 @@
+//
+// Reports how each PredictionModel would have done on a pose trace recorded on a device
+// (-pose-record), against the poses measured later in the same trace:
+//
+//     PoseTraceEval <trace> [horizon ms, default 50]
+//
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "PoseTrace.h"
+#include "openxr/PosePredictor.h"
+
+using namespace ssnwt;
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <trace> [horizon ms]\n", argv[0]);
+        return 2;
+    }
+    PoseTraceReader reader;
+    if (!reader.open(argv[1])) {
+        fprintf(stderr, "%s: not a version 2 pose trace\n", argv[1]);
+        return 1;
+    }
+    const float horizonMs = argc > 2 ? (float) atof(argv[2]) : 50.f;
+    const auto horizon = (XrDuration) (horizonMs * 1e6f);
+
+    // What was sent may already be extrapolated, only the measurements are ground truth.
+    std::vector<PoseSample> samples;
+    samples.reserve(reader.getCount());
+    for (size_t i = 0; i < reader.getCount(); i++) {
+        samples.push_back(reader.at(i).measured);
+    }
+
+    static const char *DEVICE_NAMES[Device::COUNT] = {"hmd", "left", "right"};
+    printf("%zu samples, horizon %.1f ms\n", samples.size(), horizonMs);
+    printf("%-21s %-6s %8s %11s %11s %12s %12s\n", "model", "device", "samples",
+           "angle mean", "angle max", "pos mean", "pos max");
+    for (uint32_t model = 0; model < (uint32_t) PredictionModel::COUNT; model++) {
+        const std::array<PredictionError, Device::COUNT> errors = PosePredictor::evaluate(
+                (PredictionModel) model, samples.data(), samples.size(), horizon);
+        for (int device = 0; device < Device::COUNT; device++) {
+            const PredictionError &error = errors[device];
+            if (error.count == 0) continue;
+            printf("%-21s %-6s %8u %7.3f deg %7.3f deg %9.2f mm %9.2f mm\n",
+                   PredictionModelToString((PredictionModel) model), DEVICE_NAMES[device],
+                   error.count, error.meanAngle * 57.2958f, error.maxAngle * 57.2958f,
+                   error.meanPosition * 1e3f, error.maxPosition * 1e3f);
+        }
+    }
+    return 0;
+}
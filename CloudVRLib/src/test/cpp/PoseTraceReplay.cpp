@@ -0,0 +1,120 @@
+//
+// Replays a pose trace recorded on a device (-pose-record) through the part of the tracking
+// path that needs no headset: the client-side predictor and the pose to matrix conversion.
+// Every replayed state is compared with the one the device sent, so a field trace reproduces
+// on a Linux host and doubles as a regression test of that code:
+//
+//     PoseTraceReplay <trace> [pose predictor, as -pose-predictor, default 0] [--csv]
+//
+// Exits with 1 when a replayed pose differs from the sent one.
+//
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include "PoseMath.h"
+#include "PoseTrace.h"
+#include "openxr/PosePredictor.h"
+
+using namespace ssnwt;
+
+namespace {
+    // NEON on the device and SSE here round differently.
+    constexpr float MATCH_TOLERANCE = 1e-4f;
+
+    const cxrTrackedDevicePose &sentPose(const cxrVRTrackingState &state, int device) {
+        return device == Device::HMD ? state.hmd.pose : state.controller[device - 1].pose;
+    }
+
+    // What the device's locateTrackingState turned the measurement into.
+    float replay(const PoseTraceRecord &record, PosePredictor &predictor) {
+        PoseSample sample = record.measured;
+        predictor.addSample(sample);
+        if (predictor.getModel() != PredictionModel::None) {
+            predictor.predict(sample.time + (XrDuration) (record.state.poseTimeOffset * 1e9f),
+                              &sample);
+        }
+        XrPosef poses[Device::COUNT];
+        cxrMatrix34 matrices[Device::COUNT];
+        cxrMatrix34 *out[Device::COUNT];
+        int devices[Device::COUNT];
+        size_t count = 0;
+        for (int device = 0; device < Device::COUNT; device++) {
+            // Controllers are only sent when their actions synced, skip what was not sent.
+            if (!sample.devices[device].valid || !sentPose(record.state, device).poseIsValid) {
+                continue;
+            }
+            poses[count] = sample.devices[device].pose;
+            out[count] = &matrices[count];
+            devices[count++] = device;
+        }
+        posesToMatrix34(poses, out, count);
+        float difference = 0;
+        for (size_t i = 0; i < count; i++) {
+            const cxrMatrix34 &sent = sentPose(record.state, devices[i]).deviceToAbsoluteTracking;
+            for (int r = 0; r < 3; r++) {
+                for (int c = 0; c < 4; c++) {
+                    difference = std::max(difference, fabsf(sent.m[r][c] - matrices[i].m[r][c]));
+                }
+            }
+        }
+        return difference;
+    }
+}
+
+int main(int argc, char **argv) {
+    const char *path = nullptr;
+    uint32_t model = 0;
+    bool csv = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--csv") == 0) csv = true;
+        else if (path == nullptr) path = argv[i];
+        else model = (uint32_t) atoi(argv[i]);
+    }
+    if (path == nullptr || model >= (uint32_t) PredictionModel::COUNT) {
+        fprintf(stderr, "usage: %s <trace> [pose predictor] [--csv]\n", argv[0]);
+        return 2;
+    }
+    PoseTraceReader reader;
+    if (!reader.open(path)) {
+        fprintf(stderr, "%s: not a version 2 pose trace\n", path);
+        return 1;
+    }
+    PosePredictor predictor;
+    predictor.setModel((PredictionModel) model);
+
+    if (csv) printf("time_ns,hmd_x,hmd_y,hmd_z,hmd_qx,hmd_qy,hmd_qz,hmd_qw,difference\n");
+    size_t mismatches = 0;
+    float maxDifference = 0;
+    std::chrono::nanoseconds replayTime{0};
+    for (size_t i = 0; i < reader.getCount(); i++) {
+        const PoseTraceRecord &record = reader.at(i);
+        const auto start = std::chrono::steady_clock::now();
+        const float difference = replay(record, predictor);
+        replayTime += std::chrono::steady_clock::now() - start;
+        maxDifference = std::max(maxDifference, difference);
+        if (difference > MATCH_TOLERANCE) mismatches++;
+        if (csv) {
+            const XrPosef &hmd = record.measured.devices[Device::HMD].pose;
+            printf("%lld,%f,%f,%f,%f,%f,%f,%f,%g\n", (long long) record.timeNs,
+                   hmd.position.x, hmd.position.y, hmd.position.z, hmd.orientation.x,
+                   hmd.orientation.y, hmd.orientation.z, hmd.orientation.w, difference);
+        }
+    }
+
+    const size_t count = reader.getCount();
+    const double seconds =
+            count > 1 ? (double) (reader.at(count - 1).timeNs - reader.at(0).timeNs) * 1e-9 : 0;
+    FILE *summary = csv ? stderr : stdout;
+    fprintf(summary, "%zu states over %.1f s (%.1f Hz), predictor %s\n", count, seconds,
+            seconds > 0 ? (double) (count - 1) / seconds : 0.,
+            PredictionModelToString((PredictionModel) model));
+    fprintf(summary, "replayed in %.2f us per state\n",
+            count > 0 ? (double) replayTime.count() * 1e-3 / (double) count : 0.);
+    fprintf(summary, "max matrix difference %g, %zu states differ from what was sent\n",
+            maxDifference, mismatches);
+    return mismatches > 0 ? 1 : 0;
+}
@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include "PoseTrace.h"
+
+using namespace ssnwt;
+
+namespace {
+    class PoseTraceTest : public testing::Test {
+    protected:
+        void SetUp() override {
+            char path[] = "/tmp/PoseTraceTestXXXXXX";
+            const int fd = mkstemp(path);
+            ASSERT_GE(fd, 0);
+            close(fd);
+            // Writers start from a missing or empty file.
+            mPath = path;
+        }
+
+        void TearDown() override { unlink(mPath.c_str()); }
+
+        static void append(PoseTraceWriter &writer, int64_t timeNs) {
+            cxrVRTrackingState state{};
+            state.poseTimeOffset = (float) timeNs;
+            PoseSample measured{};
+            measured.time = timeNs + 1;
+            measured.devices[Device::HMD].valid = true;
+            ASSERT_TRUE(writer.append(timeNs, state, measured));
+        }
+
+        std::string mPath;
+    };
+}
+
+TEST_F(PoseTraceTest, ReadsBackWhatWasWritten) {
+    {
+        PoseTraceWriter writer;
+        ASSERT_TRUE(writer.open(mPath.c_str()));
+        for (int64_t time = 1; time <= 3; time++) append(writer, time);
+        EXPECT_EQ(3u, writer.getCount());
+    }
+    PoseTraceReader reader;
+    ASSERT_TRUE(reader.open(mPath.c_str()));
+    ASSERT_EQ(3u, reader.getCount());
+    for (size_t i = 0; i < 3; i++) {
+        const PoseTraceRecord &record = reader.at(i);
+        EXPECT_EQ((int64_t) i + 1, record.timeNs);
+        EXPECT_FLOAT_EQ((float) i + 1, record.state.poseTimeOffset);
+        EXPECT_EQ((XrTime) i + 2, record.measured.time);
+        EXPECT_TRUE(record.measured.devices[Device::HMD].valid);
+    }
+    PoseTraceRecord record{};
+    reader.setLoop(true);
+    for (int64_t expected : {1, 2, 3, 1}) {
+        ASSERT_TRUE(reader.next(&record));
+        EXPECT_EQ(expected, record.timeNs);
+    }
+}
+
+TEST_F(PoseTraceTest, ReopeningAppendsInsteadOfTruncating) {
+    PoseTraceWriter writer;
+    ASSERT_TRUE(writer.open(mPath.c_str()));
+    append(writer, 1);
+    append(writer, 2);
+    writer.close();
+    // A pause and resume, or the next app session.
+    ASSERT_TRUE(writer.open(mPath.c_str()));
+    EXPECT_EQ(2u, writer.getCount());
+    append(writer, 3);
+    writer.close();
+
+    PoseTraceReader reader;
+    ASSERT_TRUE(reader.open(mPath.c_str()));
+    ASSERT_EQ(3u, reader.getCount());
+    EXPECT_EQ(3, reader.at(2).timeNs);
+}
+
+TEST_F(PoseTraceTest, UnwrittenRecordsOfAnOpenTraceAreSkipped) {
+    PoseTraceWriter writer;
+    ASSERT_TRUE(writer.open(mPath.c_str()));
+    append(writer, 1);
+    append(writer, 2);
+    // The file is a whole mapped chunk until close(), as after a crash.
+    PoseTraceReader reader;
+    ASSERT_TRUE(reader.open(mPath.c_str()));
+    EXPECT_EQ(2u, reader.getCount());
+    reader.close();
+
+    PoseTraceWriter second;
+    ASSERT_TRUE(second.open(mPath.c_str()));
+    EXPECT_EQ(2u, second.getCount());
+}
+
+TEST_F(PoseTraceTest, LeavesOtherFilesAlone) {
+    {
+        std::ofstream other(mPath);
+        other << "not a pose trace";
+    }
+    PoseTraceWriter writer;
+    EXPECT_FALSE(writer.open(mPath.c_str()));
+    EXPECT_FALSE(writer.isOpen());
+    std::ifstream in(mPath);
+    std::stringstream contents;
+    contents << in.rdbuf();
+    EXPECT_EQ("not a pose trace", contents.str());
+
+    PoseTraceReader reader;
+    EXPECT_FALSE(reader.open(mPath.c_str()));
+}
+
+TEST(PoseTraceConversionTest, DecodesTrackingStates) {
+    cxrVRTrackingState state{};
+    const XrQuaternionf q{0, 0.6f, 0, 0.8f};
+    state.hmd.pose.deviceToAbsoluteTracking = {{{0.28f, 0, 0.96f, 1},
+                                                {0, 1, 0, 2},
+                                                {-0.96f, 0, 0.28f, 3}}};
+    state.hmd.pose.poseIsValid = cxrTrue;
+    state.hmd.pose.angularVelocity = {{0, 1, 0}};
+    PoseSample sample{};
+    trackingStateToSample(42, state, &sample);
+    EXPECT_EQ(42, sample.time);
+    const DevicePose &hmd = sample.devices[Device::HMD];
+    EXPECT_TRUE(hmd.valid);
+    EXPECT_NEAR(q.y, hmd.pose.orientation.y, 1e-5f);
+    EXPECT_NEAR(q.w, hmd.pose.orientation.w, 1e-5f);
+    EXPECT_FLOAT_EQ(2, hmd.pose.position.y);
+    EXPECT_FLOAT_EQ(1, hmd.angularVelocity.y);
+    EXPECT_FALSE(sample.devices[Device::LEFT_HAND].valid);
+}
@@ -0,0 +1,30 @@
+//
+// Host stand-in for the NDK log, warnings and errors go to stderr.
+//
+
+#ifndef CLOUDXR_TEST_ANDROID_LOG_H
+#define CLOUDXR_TEST_ANDROID_LOG_H
+
+#include <cstdarg>
+#include <cstdio>
+
+enum {
+    ANDROID_LOG_VERBOSE = 2,
+    ANDROID_LOG_DEBUG,
+    ANDROID_LOG_INFO,
+    ANDROID_LOG_WARN,
+    ANDROID_LOG_ERROR,
+};
+
+inline int __android_log_print(int prio, const char *tag, const char *fmt, ...) {
+    if (prio < ANDROID_LOG_WARN) return 0;
+    va_list args;
+    va_start(args, fmt);
+    fprintf(stderr, "%s: ", tag);
+    const int n = vfprintf(stderr, fmt, args);
+    fputc('\n', stderr);
+    va_end(args);
+    return n;
+}
+
+#endif //CLOUDXR_TEST_ANDROID_LOG_H
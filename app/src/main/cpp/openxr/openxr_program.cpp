@@ -729,6 +729,7 @@ namespace {
 
             // Create and cache view buffer for xrLocateViews later.
             m_views.resize(viewCount, {XR_TYPE_VIEW});
+            m_projectionLayerViews.resize(viewCount);
 
             // Create the swapchain and get the images.
             if (viewCount > 0) {
@@ -1031,27 +1032,29 @@ namespace {
             XrFrameBeginInfo frameBeginInfo{XR_TYPE_FRAME_BEGIN_INFO};
             CHECK_XRCMD(xrBeginFrame(m_session, &frameBeginInfo));
 
-            std::vector<XrCompositionLayerBaseHeader *> layers;
             XrCompositionLayerProjection layer{XR_TYPE_COMPOSITION_LAYER_PROJECTION};
-            std::vector<XrCompositionLayerProjectionView> projectionLayerViews;
+            const XrCompositionLayerBaseHeader *layers[] = {
+                    reinterpret_cast<XrCompositionLayerBaseHeader *>(&layer)};
+            uint32_t layerCount = 0;
             if (frameState.shouldRender == XR_TRUE) {
-                if (RenderLayer(frameState.predictedDisplayTime, projectionLayerViews, layer)) {
-                    layers.push_back(reinterpret_cast<XrCompositionLayerBaseHeader *>(&layer));
+                if (RenderLayer(frameState.predictedDisplayTime, layer)) {
+                    layerCount = 1;
                 }
             }
 
             XrFrameEndInfo frameEndInfo{XR_TYPE_FRAME_END_INFO};
             frameEndInfo.displayTime = frameState.predictedDisplayTime;
             frameEndInfo.environmentBlendMode = m_environmentBlendMode;
-            frameEndInfo.layerCount = (uint32_t) layers.size();
-            frameEndInfo.layers = layers.data();
+            frameEndInfo.layerCount = layerCount;
+            frameEndInfo.layers = layers;
             CHECK_XRCMD(xrEndFrame(m_session, &frameEndInfo));
         }
 
-        bool RenderLayer(XrTime predictedDisplayTime,
-                         std::vector<XrCompositionLayerProjectionView> &projectionLayerViews,
-                         XrCompositionLayerProjection &layer) {
+        bool RenderLayer(XrTime predictedDisplayTime, XrCompositionLayerProjection &layer) {
             XrResult res;
+            // Sized at initialization, layer.views points into it until xrEndFrame.
+            std::vector<XrCompositionLayerProjectionView> &projectionLayerViews =
+                    m_projectionLayerViews;
 
             XrViewState viewState{XR_TYPE_VIEW_STATE};
             uint32_t viewCapacityInput = (uint32_t) m_views.size();
@@ -1089,7 +1092,7 @@ namespace {
             // Render view to the appropriate part of the swapchain image.
             for (uint32_t i = 0; i < viewCountOutput; i++) {
                 // Each view has a separate swapchain which is acquired, rendered to, and released.
-                const Swapchain viewSwapchain = m_swapchains[i];
+                const Swapchain &viewSwapchain = m_swapchains[i];
 
                 XrSwapchainImageAcquireInfo acquireInfo{XR_TYPE_SWAPCHAIN_IMAGE_ACQUIRE_INFO};
 
@@ -1139,6 +1142,7 @@ namespace {
         std::vector<Swapchain> m_swapchains;
         std::map<XrSwapchain, std::vector<XrSwapchainImageBaseHeader *>> m_swapchainImages;
         std::vector<XrView> m_views;
+        std::vector<XrCompositionLayerProjectionView> m_projectionLayerViews;
         int64_t m_colorSwapchainFormat{-1};
 
         std::vector<XrSpace> m_visualizedSpaces;